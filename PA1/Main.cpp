@@ -1,13 +1,264 @@
 #include "lex.h"
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <unordered_set>
+#include <unordered_map>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
 #include <bits/stdc++.h>
 
 using namespace std;
 
+//Where a keyword was first seen: file index, then token index in that file
+typedef pair<size_t, int> TokenPos;
+
+//Token statistics for one file, or merged over several
+struct Stats {
+	int lines;
+	int tokens;
+
+	//distinct tokens are kept in hash sets and only sorted for the report
+	unordered_set<float> numerals;
+	unordered_set<string> ids;
+	unordered_map<string, TokenPos> keywords;
+	vector<string> strings;
+
+	Stats() : lines(0), tokens(0) {}
+
+	//Add other's counts and distinct tokens to these
+	void Merge(const Stats& other) {
+		lines += other.lines;
+		tokens += other.tokens;
+		numerals.insert(other.numerals.begin(), other.numerals.end());
+		ids.insert(other.ids.begin(), other.ids.end());
+		for (auto& kw : other.keywords) {
+			auto found = keywords.insert(kw);
+			if (!found.second && kw.second < found.first->second)
+				found.first->second = kw.second;
+		}
+		strings.insert(strings.end(), other.strings.begin(), other.strings.end());
+	}
+};
+
+static bool IsKeyword(Token token) {
+	switch (token) {
+	case Token::IF:
+	case Token::ELSE:
+	case Token::ELSIF:
+	case Token::PUT:
+	case Token::PUTLN:
+	case Token::GET:
+	case Token::INT:
+	case Token::FLOAT:
+	case Token::CHAR:
+	case Token::STRING:
+	case Token::BOOL:
+	case Token::PROCEDURE:
+	case Token::TRUE:
+	case Token::FALSE:
+	case Token::END:
+	case Token::IS:
+	case Token::THEN:
+	case Token::CONST:
+	case Token::AND:
+	case Token::MOD:
+	case Token::OR:
+	case Token::NOT:
+	case Token::BEGIN:
+		return true;
+	default:
+		return false;
+	}
+}
+
+//Whole contents of an open file
+static string ReadAll(istream& in) {
+	ostringstream text;
+	text << in.rdbuf();
+	return text.str();
+}
+
+//Lex the whole buffer into stats, writing every token to out when printAll
+//is set. On an error the error token is written to out and false returned.
+static bool CollectStats(LexBuffer& in, size_t fileIndex, bool printAll, ostream& out, Stats& stats) {
+	while(!in.eof()) {
+		LexItem lexItem = getNextToken(in,stats.lines);
+		//if we get error , break the loop and exit
+		if (lexItem.GetToken() == Token::ERR) {
+			out<< lexItem;
+			return false;
+		}
+		//if we are done, then exit
+		if (lexItem.GetToken() == Token::DONE) {
+			break;
+		}
+
+		stats.tokens++;
+		if (printAll)
+			out<< lexItem;
+
+		if (lexItem.GetToken() == Token::ICONST || lexItem.GetToken() == Token::FCONST) {
+			stats.numerals.insert(stof(lexItem.GetLexeme()));
+		}
+		if (lexItem.GetToken() == Token::SCONST ) {
+			stats.strings.push_back(lexItem.GetLexeme());
+		}
+		if (lexItem.GetToken() == Token::CCONST) {
+			stats.strings.push_back("\""+ lexItem.GetLexeme() + "\"");
+		}
+		if (lexItem.GetToken() == Token::IDENT) {
+			stats.ids.insert(lexItem.GetLexeme());
+		}
+		//keywords are reported in the order they first appear
+		if (IsKeyword(lexItem.GetToken())) {
+			stats.keywords.insert(make_pair(lexItem.GetLexeme(), TokenPos(fileIndex, stats.tokens)));
+		}
+	}
+	return true;
+}
+
+template <class T>
+static void PrintList(const char* title, const vector<T>& items) {
+	std::cout<<title<<endl;
+	for (size_t i = 0; i < items.size(); i++) {
+		std::cout<<items[i];
+		if (i<items.size()-1)
+			std::cout <<", ";
+	}
+	std::cout<<endl;
+}
+
+static void Report(Stats& stats, bool printString, bool printNum, bool printId, bool printKW) {
+	std::cout<<endl;
+	std::cout <<"Lines: "<<stats.lines<<endl;
+	std::cout <<"Total Tokens: "<<stats.tokens<<endl;
+	std::cout <<"Numerals: "<<stats.numerals.size()<<endl;
+	std::cout<<"Characters and Strings : " <<stats.strings.size()<<endl;
+	std::cout<<"Identifiers: " <<stats.ids.size()<<endl;
+	std::cout<<"Keywords: "<<stats.keywords.size() <<endl;
+
+	vector<float> numerals(stats.numerals.begin(), stats.numerals.end());
+	vector<string> ids(stats.ids.begin(), stats.ids.end());
+	vector<pair<TokenPos, string> > seen;
+	for (auto& kw : stats.keywords)
+		seen.push_back(make_pair(kw.second, kw.first));
+	sort(stats.strings.begin(), stats.strings.end());
+	sort(ids.begin(), ids.end());
+	sort(numerals.begin(), numerals.end());
+	sort(seen.begin(), seen.end());
+	vector<string> keywords;
+	for (auto& kw : seen)
+		keywords.push_back(kw.second);
+
+	if (numerals.size() > 0 && printNum)
+		PrintList("NUMERIC CONSTANTS:", numerals);
+	if (stats.strings.size() > 0 && printString)
+		PrintList("CHARACTERS AND STRINGS:", stats.strings);
+	if (ids.size() > 0 && printId)
+		PrintList("IDENTIFIERS:", ids);
+	if (keywords.size() > 0 && printKW)
+		PrintList("KEYWORDS:", keywords);
+}
+
+//Lex the files on jobs threads, each keeping its own statistics, and
+//merge them into one report. Token listings and errors are printed per
+//file, in file order, under a "==> name <==" heading; a file with a
+//lexical error is left out of the totals.
+static int RunFiles(const vector<string>& files, unsigned jobs,
+		bool printAll, bool printString, bool printNum, bool printId, bool printKW) {
+	vector<string> output(files.size());
+	vector<Stats> partial(jobs);
+	atomic<size_t> next(0);
+
+	auto worker = [&](unsigned self) {
+		for (size_t i = next++; i < files.size(); i = next++) {
+			ifstream inputFile(files[i].c_str());
+			if (!inputFile.is_open()) {
+				output[i] = "CANNOT OPEN THE FILE " + files[i] + "\n";
+				continue;
+			}
+			string text = ReadAll(inputFile);
+			LexBuffer in(text);
+			ostringstream out;
+			Stats stats;
+			if (CollectStats(in, i, printAll, out, stats))
+				partial[self].Merge(stats);
+			else
+				out<<endl;
+			output[i] = out.str();
+		}
+	};
+
+	vector<thread> pool;
+	for (unsigned j = 0; j < jobs; j++)
+		pool.push_back(thread(worker, j));
+	for (size_t j = 0; j < pool.size(); j++)
+		pool[j].join();
+
+	for (size_t i = 0; i < files.size(); i++) {
+		if (!output[i].empty())
+			std::cout<<"==> "<<files[i]<<" <=="<<endl<<output[i];
+	}
+	for (unsigned j = 1; j < jobs; j++)
+		partial[0].Merge(partial[j]);
+	Report(partial[0], printString, printNum, printId, printKW);
+	return 0;
+}
+
+//Multi-file mode: -jobs N followed by any number of files and the usual
+//flags. N is the number of lexing threads; 0 means one per core.
+static int MultiFileMain(int argc, char **argv) {
+	vector<string> files;
+	bool printAll = false;
+	bool printString = false;
+	bool printNum = false;
+	bool printId = false;
+	bool printKW = false;
+	unsigned jobs = 1;
+
+	for (int i = 1; i < argc; i++) {
+		string arugment = argv[i];
+		if (arugment == "-jobs") {
+			if (++i == argc) {
+				std::cout << "Missing number of jobs." << endl;
+				return 0;
+			}
+			jobs = atoi(argv[i]);
+			if (jobs == 0)
+				jobs = thread::hardware_concurrency();
+			if (jobs == 0)
+				jobs = 1;
+		} else if (arugment == "-all") {
+			printAll = true;
+		} else if (arugment == "-num") {
+			printNum = true;
+		} else if (arugment == "-str") {
+			printString = true;
+		} else if (arugment == "-id") {
+			printId = true;
+		} else if (arugment == "-kw") {
+			printKW = true;
+		} else if (arugment[0] == '-') {
+			std::cout << "Unrecognized flag {" << arugment << "}" << endl;
+			return 0;
+		} else {
+			files.push_back(arugment);
+		}
+	}
+	if (files.empty()) {
+		std::cout<<"No specified input file."<<endl;
+		return 0;
+	}
+	if (jobs > files.size())
+		jobs = files.size();
+	return RunFiles(files, jobs, printAll, printString, printNum, printId, printKW);
+}
+
 //DRIVER CODE
 int main(int argc, char **argv) {
 
@@ -21,19 +272,12 @@ int main(int argc, char **argv) {
 	bool printKW = false;
 	int fileNameCount = 0;
 	string fileName;
+	Stats stats;
 
-	int lineNumber =0;
-	int totalTokens = 0;
-	int totalNumerals = 0;
-	int totalStrings = 0;
-	int totalIds = 0;
-	int totalKeywords = 0;
-
-	vector<string> keywords;
-	vector<float> numerals;
-	vector<string> strings;
-	vector<string> ids;
-	bool isError = false;
+	for (int i = 1; i < argc; i++) {
+		if (string(argv[i]) == "-jobs")
+			return MultiFileMain(argc, argv);
+	}
 
 	//check arguments
 	if (argc == 1) {
@@ -79,151 +323,13 @@ int main(int argc, char **argv) {
             }
 		}
 	}
-	basic_istream<char> &in= inputFile;
 
-	//iterate through the stream
-	while(!in.eof()) {
-		LexItem lexItem = getNextToken(in,lineNumber);
-		//if we get error , break the loop and exit
-		if (lexItem.GetToken() == Token::ERR) {
-			std::cout<< lexItem;
-			isError = true;
-			break;
-		}
-		//if we are done, then exit
-		if (lexItem.GetToken() == Token::DONE) {
-			break;
-		}
-
-		totalTokens++;
-		if (lexItem.GetToken() != Token::DONE && printAll)
-			std::cout<< lexItem;
-
-		if (lexItem.GetToken() == Token::ICONST) {
-			auto itemFound = std::find(numerals.begin(), numerals.end(), stof(lexItem.GetLexeme()));
-			if (itemFound == numerals.end()) {
-				numerals.push_back(stof(lexItem.GetLexeme()));
-				totalNumerals++;
-			}
-		}
-
-		if (lexItem.GetToken() == Token::FCONST) {
-			auto itemFound = std::find(numerals.begin(), numerals.end(), stof(lexItem.GetLexeme()));
-			if (itemFound == numerals.end()) {
-				numerals.push_back(stof(lexItem.GetLexeme()));
-				totalNumerals++;
-			}
-		}
-		if (lexItem.GetToken() == Token::SCONST ) {
-			strings.push_back(lexItem.GetLexeme());
-			totalStrings++;
-		}
-		if (lexItem.GetToken() == Token::CCONST) {
-			string char_const = "\""+ lexItem.GetLexeme() + "\"";
-			strings.push_back(char_const);
-			totalStrings++;
-		}
-		if (lexItem.GetToken() == Token::IDENT) {
-			auto itemFound = std::find(ids.begin(), ids.end(), lexItem.GetLexeme());
-			if (itemFound == ids.end()) {
-				ids.push_back(lexItem.GetLexeme());
-				totalIds++;
-			}
-		}
-		if (lexItem.GetToken() == Token::IF
-				|| lexItem.GetToken() == Token::ELSE
-				|| lexItem.GetToken() == Token::ELSIF
-				|| lexItem.GetToken() == Token::PUT
-				|| lexItem.GetToken() == Token::PUTLN
-				|| lexItem.GetToken() == Token::GET
-				|| lexItem.GetToken() == Token::INT
-				|| lexItem.GetToken() == Token::FLOAT
-				|| lexItem.GetToken() == Token::CHAR
-				|| lexItem.GetToken() == Token::STRING
-				|| lexItem.GetToken() == Token::BOOL
-				|| lexItem.GetToken() == Token::PROCEDURE
-				|| lexItem.GetToken() == Token::TRUE
-				|| lexItem.GetToken() == Token::FALSE
-				|| lexItem.GetToken() == Token::END
-				|| lexItem.GetToken() == Token::IS
-				|| lexItem.GetToken() == Token::THEN
-				|| lexItem.GetToken() == Token::CONST
-				|| lexItem.GetToken() == Token::AND
-				|| lexItem.GetToken() == Token::MOD
-				|| lexItem.GetToken() == Token::OR
-				|| lexItem.GetToken() == Token::NOT
-				|| lexItem.GetToken() == Token::BEGIN
-
-		) {
-			auto itemFound = std::find(keywords.begin(), keywords.end(), lexItem.GetLexeme());
-			if (itemFound == keywords.end()) {
-				keywords.push_back(lexItem.GetLexeme());
-				totalKeywords++;
-			}
-		}
-
-	}
-
-	if (isError) {
+	//lex from the file contents held in memory
+	string text = ReadAll(inputFile);
+	LexBuffer in(text);
+	if (!CollectStats(in, 0, printAll, std::cout, stats)) {
 		std::cout<<endl;
 		return 0;
 	}
-
-	std::cout<<endl;
-	std::cout <<"Lines: "<<lineNumber<<endl;
-	std::cout <<"Total Tokens: "<<totalTokens<<endl;
-	std::cout <<"Numerals: "<<totalNumerals<<endl;
-	std::cout<<"Characters and Strings : " <<totalStrings<<endl;
-	std::cout<<"Identifiers: " <<totalIds<<endl;
-	std::cout<<"Keywords: "<<totalKeywords <<endl;
-	stable_sort(strings.begin(), strings.end());
-	stable_sort(ids.begin(), ids.end());
-	stable_sort(numerals.begin(), numerals.end());
-
-	if (numerals.size() > 0 && printNum) {
-		std::cout<<"NUMERIC CONSTANTS:"<<endl;
-		int i = 0;
-		for (auto it1 : numerals){
-			std::cout<<it1;
-			if (i<numerals.size()-1)
-				std::cout <<", ";
-			i++;
-		}
-		std::cout<<endl;
-	}
-
-	if (strings.size() > 0 && printString) {
-		std::cout<<"CHARACTERS AND STRINGS:"<<endl;
-		int i =0;
-		for (auto it2 : strings){
-			std::cout<<it2;
-			if (i<strings.size()-1)
-				std::cout <<", ";
-			i++;
-		}
-		std::cout<<endl;
-	}
-
-	if (ids.size() > 0 && printId) {
-		std::cout<<"IDENTIFIERS:"<<endl;
-		int i=0;
-		for (auto it3 : ids){
-			std::cout<<it3;
-			if (i<ids.size()-1)
-				std::cout <<", ";
-			i++;
-		}
-		std::cout<<endl;
-	}
-	if (keywords.size() > 0 && printKW) {
-		std::cout<<"KEYWORDS:"<<endl;
-		int i = 0;
-		for (auto it4 : keywords){
-			std::cout<<it4;
-			if (i<keywords.size()-1)
-				std::cout <<", ";
-			i++;
-		}
-		std::cout<<endl;
-	}
+	Report(stats, printString, printNum, printId, printKW);
 }
@@ -1,495 +1,349 @@
 #include "lex.h"
 #include <cstring>
 
-/**
- * This function is used to check whether the given character is alpha numeric,
- * 0-9, a-z, A-Z, _
+/*
+ * The lexer is a table-driven DFA. Every input character falls into one
+ * of the classes below, and the transition table maps (state, class) to
+ * either the next state, in which case the character is consumed, or to
+ * an action that ends the scan and builds the token. Both tables are
+ * computed at compile time.
  */
-bool is_alpha_numeric(char c) noexcept {
-	switch (c) {
-	case 'a':
-	case 'b':
-	case 'c':
-	case 'd':
-	case 'e':
-	case 'f':
-	case 'g':
-	case 'h':
-	case 'i':
-	case 'j':
-	case 'k':
-	case 'l':
-	case 'm':
-	case 'n':
-	case 'o':
-	case 'p':
-	case 'q':
-	case 'r':
-	case 's':
-	case 't':
-	case 'u':
-	case 'v':
-	case 'w':
-	case 'x':
-	case 'y':
-	case 'z':
-	case 'A':
-	case 'B':
-	case 'C':
-	case 'D':
-	case 'E':
-	case 'F':
-	case 'G':
-	case 'H':
-	case 'I':
-	case 'J':
-	case 'K':
-	case 'L':
-	case 'M':
-	case 'N':
-	case 'O':
-	case 'P':
-	case 'Q':
-	case 'R':
-	case 'S':
-	case 'T':
-	case 'U':
-	case 'V':
-	case 'W':
-	case 'X':
-	case 'Y':
-	case 'Z':
-	case '0':
-	case '1':
-	case '2':
-	case '3':
-	case '4':
-	case '5':
-	case '6':
-	case '7':
-	case '8':
-	case '9':
-	case '_':
-		return true;
-	default:
-		return false;
-	}
-}
+
+//Character classes; C_END is end of input
+enum CharClass {
+	C_END, C_OTHER, C_SPACE, C_NL, C_E, C_LETTER, C_DIGIT, C_US,
+	C_MINUS, C_PLUS, C_DOT, C_DQUOTE, C_SQUOTE, C_STAR, C_LT, C_GT,
+	C_EQ, C_COLON, C_SLASH, C_LPAREN, C_RPAREN, C_AMP, C_SEMI, C_COMMA,
+	C_COUNT
+};
+
+//Scanner states, followed by the actions that end a scan
+enum ScanState {
+	S_START, S_MINUS, S_COMMENT, S_ID, S_IDUS, S_NUM, S_STR, S_CH1,
+	S_CH2, S_STAR, S_LT, S_GT, S_COLON, S_SLASH,
+	S_COUNT,
+
+	A_DONE = S_COUNT, A_ERRCHAR, A_ID, A_NUM, A_STR, A_STRBAD, A_STREOF,
+	A_CH, A_CHNL, A_CHBAD, A_CHEOF1, A_CHEOF2, A_MINUS, A_MULT, A_EXP,
+	A_LTHAN, A_LTE, A_GTHAN, A_GTE, A_COLON, A_ASSOP, A_DIV, A_NEQ,
+	A_EQ, A_PLUS, A_CONCAT, A_DOT, A_LPAREN, A_RPAREN, A_SEMICOL, A_COMMA,
+	A_END
+};
 
 /**
- * This function is used to check whether
- * given character is space or \t or \r
+ * This function gives the class of a character, or of EOF (-1)
  */
-bool is_space(char c)  {
-	switch (c) {
-	case ' ':
-	case '\t':
-	case '\r':
-		return true;
-	default:
-		return false;
-	}
+static constexpr unsigned char ClassOf(int c) {
+	return c == -1 ? C_END
+		: (c == ' ' || c == '\t' || c == '\r') ? C_SPACE
+		: c == '\n' ? C_NL
+		: (c == 'e' || c == 'E') ? C_E
+		: ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) ? C_LETTER
+		: (c >= '0' && c <= '9') ? C_DIGIT
+		: c == '_' ? C_US
+		: c == '-' ? C_MINUS
+		: c == '+' ? C_PLUS
+		: c == '.' ? C_DOT
+		: c == '"' ? C_DQUOTE
+		: c == '\'' ? C_SQUOTE
+		: c == '*' ? C_STAR
+		: c == '<' ? C_LT
+		: c == '>' ? C_GT
+		: c == '=' ? C_EQ
+		: c == ':' ? C_COLON
+		: c == '/' ? C_SLASH
+		: c == '(' ? C_LPAREN
+		: c == ')' ? C_RPAREN
+		: c == '&' ? C_AMP
+		: c == ';' ? C_SEMI
+		: c == ',' ? C_COMMA
+		: C_OTHER;
 }
 
+//Class of every character, indexed by the character + 1 so EOF is entry 0
+#define CC1(i) ClassOf((i) - 1)
+#define CC4(i) CC1(i), CC1((i) + 1), CC1((i) + 2), CC1((i) + 3)
+#define CC16(i) CC4(i), CC4((i) + 4), CC4((i) + 8), CC4((i) + 12)
+#define CC64(i) CC16(i), CC16((i) + 16), CC16((i) + 32), CC16((i) + 48)
+static constexpr unsigned char charClass[257] = {
+	CC64(0), CC64(64), CC64(128), CC64(192), CC1(256)
+};
+#undef CC64
+#undef CC16
+#undef CC4
+#undef CC1
 
 /**
- * This function is used to check whether
- * given character is numeric 0 to 9
+ * Transitions out of the start state; blanks and new lines are skipped,
+ * any character that cannot start a token is an error
  */
-bool is_numeric(char c)  {
-	switch (c) {
-	case '0':
-	case '1':
-	case '2':
-	case '3':
-	case '4':
-	case '5':
-	case '6':
-	case '7':
-	case '8':
-	case '9':
-		return true;
-	default:
-		return false;
-	}
+static constexpr ScanState FromStart(int c) {
+	return c == C_END ? A_DONE
+		: (c == C_SPACE || c == C_NL) ? S_START
+		: (c == C_E || c == C_LETTER) ? S_ID
+		: c == C_DIGIT ? S_NUM
+		: c == C_MINUS ? S_MINUS
+		: c == C_PLUS ? A_PLUS
+		: c == C_DOT ? A_DOT
+		: c == C_DQUOTE ? S_STR
+		: c == C_SQUOTE ? S_CH1
+		: c == C_STAR ? S_STAR
+		: c == C_LT ? S_LT
+		: c == C_GT ? S_GT
+		: c == C_EQ ? A_EQ
+		: c == C_COLON ? S_COLON
+		: c == C_SLASH ? S_SLASH
+		: c == C_LPAREN ? A_LPAREN
+		: c == C_RPAREN ? A_RPAREN
+		: c == C_AMP ? A_CONCAT
+		: c == C_SEMI ? A_SEMICOL
+		: c == C_COMMA ? A_COMMA
+		: A_ERRCHAR;
 }
 
-/**
- * This function is used to whether the current stream is
- * a valid identifier of keyword in SADAL language,
- * the allowed ids or keywords are mentioned in the
- * requirement document
- */
-LexItem identifier(istream& in, int& linenum)  {
-	string sequence;
-	char inp = in.get();
-	char prev = '\0';
-	sequence += inp;
-	// loop until we find alpha numeric chars
-	while (is_alpha_numeric(in.peek())){
-		inp = in.get();
-		//if we happen to find consecutive underscore, then it may be an error
-		if (inp == '_' && prev == '_') {
-			in.putback(inp);
-			break;
-		}
-		sequence+= inp;
-		prev = inp;
-	}
-	//convert to lower case , as its important to print in lowers
-	string lower ="";
-	for(auto letter : sequence)
-		lower += std::tolower(letter);
-	return id_or_kw(lower,linenum);
+static constexpr bool IsIdChar(int c) {
+	return c == C_E || c == C_LETTER || c == C_DIGIT;
 }
 
 /**
- * Function used to check whether the current stream is
- * a string constant , starts with a double quote and ends with
- * a double quote.
+ * This function gives the transition for a state and a character class.
+ * - a '-' is a MINUS unless another '-' follows and starts a comment,
+ *   which runs to the end of the line
+ * - identifiers may not contain two consecutive underscores; the scan
+ *   stops before the second one
+ * - numerals take in digits, '.', 'e', 'E', '-' and '+'; the trailing
+ *   'e' and '.' fix-ups are done when the token is built
+ * - strings end at the closing quote, or in error at a new line or EOF
  */
-LexItem stringconst(istream& in, int& linenum)  {
-	string sequence;
-	char inp = in.get();
-	sequence += inp;
-	//loop until we find a new line or eof or double quotes
-	while (in.peek()!= '"' && in.peek()!= '\n' && !in.eof()){
-		inp = in.get();
-		sequence+= inp;
-	}
-	sequence +=in.get();
-	char last = sequence[sequence.length()-1];
-	if (last !='"') { // if last char is not a double quote, then its invalid
-		sequence[sequence.length()-1] = '\0';
-		return LexItem(Token::ERR, " Invalid string constant "+sequence,linenum);
-	}
-	return LexItem(Token::SCONST, sequence,linenum);
+static constexpr ScanState Step(int s, int c) {
+	return s == S_START ? FromStart(c)
+		: s == S_MINUS ? (c == C_MINUS ? S_COMMENT : A_MINUS)
+		: s == S_COMMENT ? (c == C_NL ? S_START : c == C_END ? A_DONE : S_COMMENT)
+		: s == S_ID ? (IsIdChar(c) ? S_ID : c == C_US ? S_IDUS : A_ID)
+		: s == S_IDUS ? (IsIdChar(c) ? S_ID : A_ID)
+		: s == S_NUM ? ((c == C_DIGIT || c == C_DOT || c == C_E || c == C_MINUS || c == C_PLUS) ? S_NUM : A_NUM)
+		: s == S_STR ? (c == C_DQUOTE ? A_STR : c == C_NL ? A_STRBAD : c == C_END ? A_STREOF : S_STR)
+		: s == S_CH1 ? (c == C_NL ? A_CHNL : c == C_END ? A_CHEOF1 : S_CH2)
+		: s == S_CH2 ? (c == C_SQUOTE ? A_CH : c == C_END ? A_CHEOF2 : A_CHBAD)
+		: s == S_STAR ? (c == C_STAR ? A_EXP : A_MULT)
+		: s == S_LT ? (c == C_EQ ? A_LTE : A_LTHAN)
+		: s == S_GT ? (c == C_EQ ? A_GTE : A_GTHAN)
+		: s == S_COLON ? (c == C_EQ ? A_ASSOP : A_COLON)
+		: (c == C_EQ ? A_NEQ : A_DIV);
 }
 
+#define ST1(s, c) Step(s, c)
+#define ST4(s, c) ST1(s, c), ST1(s, (c) + 1), ST1(s, (c) + 2), ST1(s, (c) + 3)
+#define ROW(s) { ST4(s, 0), ST4(s, 4), ST4(s, 8), ST4(s, 12), ST4(s, 16), ST4(s, 20) }
+static_assert(C_COUNT == 24, "ROW() covers 24 character classes");
+static constexpr unsigned char transitions[S_COUNT][C_COUNT] = {
+	ROW(S_START), ROW(S_MINUS), ROW(S_COMMENT), ROW(S_ID), ROW(S_IDUS),
+	ROW(S_NUM), ROW(S_STR), ROW(S_CH1), ROW(S_CH2), ROW(S_STAR),
+	ROW(S_LT), ROW(S_GT), ROW(S_COLON), ROW(S_SLASH)
+};
+#undef ROW
+#undef ST4
+#undef ST1
+
 /**
- * Function used to check whether the current stream is
- * a char constant , starts with a single quote and ends with
- * a single quote.
- * only one char allowed, new line is not allowed
+ * Whether an action takes the character it stopped on into the token
  */
-LexItem charconst(istream& in, int& linenum)  {
-	string sequence;
-	char inp = in.get();
-	inp = in.get();
-	if (inp == '\n'){ // new line is invalid
-		return LexItem(Token::ERR, "New line is an invalid character constant.",linenum);
-	}
-	sequence += inp;
-	inp = in.get();
-	if (inp !='\''){ // if last char is not a single quote, then its invalid
-		sequence +=inp;
-		string msg = "Invalid character constant '" + sequence + "'";
-		return LexItem(Token::ERR, msg,linenum);
-	}
-	return LexItem(Token::CCONST, sequence,linenum);
+static constexpr bool Consumes(int a) {
+	return a == A_STR || a == A_STRBAD || a == A_CH || a == A_CHNL
+		|| a == A_CHBAD || a == A_EXP || a == A_LTE || a == A_GTE
+		|| a == A_ASSOP || a == A_NEQ || a == A_EQ || a == A_PLUS
+		|| a == A_CONCAT || a == A_DOT || a == A_LPAREN || a == A_RPAREN
+		|| a == A_SEMICOL || a == A_COMMA;
 }
 
+#define CO1(a) Consumes(a)
+#define CO4(a) CO1(a), CO1((a) + 1), CO1((a) + 2), CO1((a) + 3)
+static_assert(A_END - A_DONE <= 32, "consumes[] covers 32 actions");
+static constexpr bool consumes[32] = {
+	CO4(A_DONE), CO4(A_DONE + 4), CO4(A_DONE + 8), CO4(A_DONE + 12),
+	CO4(A_DONE + 16), CO4(A_DONE + 20), CO4(A_DONE + 24), CO4(A_DONE + 28)
+};
+#undef CO4
+#undef CO1
+
 /**
- * Function used to check whether the current stream is
- * a numeric constant , start with a numeric and ends with
- * a numeric, only one dot is allowed and exp is allowed, with -, +
- * only one char allowed, new line is not allowed
+ * Cursor over contiguous text; the lexeme is a slice of the buffer
  */
-LexItem number(istream& in,int& linenum)  {
-	string sequence;
-	sequence += in.get();
-	bool fconst = false;
-	int dotCount = 0;
-	// loop through the stream until we find 0-9, - , +, e, E, .
-	while (is_numeric(in.peek()) || in.peek() == '.'
-			|| in.peek() == 'E' || in.peek() == 'e' || in.peek() == '-' || in.peek() == '+'){
-		if (in.peek() == '.') {
-			fconst = true;
-		}
-		sequence +=in.get();
-	}
-	//this block of code will remove 'e' or 'E' at the end of accumulated sequence
-	//and put back into the stream
-	int ss = sequence.length();
-	if (sequence[ss-1] == 'e' || sequence[ss-1] == 'E') {
-		char last = sequence[ss-1];
-		sequence[ss-1] = '\0';
-		in.putback(last);
-	}
-
-	//this block of code will remove '.' at the end of accumulated sequence
-	//and put back into the stream
-	string temp = sequence;
-	while(true) {
-		int initial = sequence.length();
-		if (sequence[initial-1] == '.') {
-			sequence[initial-1] = '\0';
-			sequence.resize(initial-1);
-			in.putback('.');
-		}
-		else
-			break;
-		fconst = false;
-	}
+class BufferCursor {
+	LexBuffer& buf;
+	const char* start;
 
-	//this block of code will analyze ,sequence has got more than one dot
-	//and if so, return error
-	string errseq;
-	for (int k=0; k <sequence.length(); k++) {
-		errseq += sequence[k];
-		if (sequence[k] == '.') {
-			if (dotCount>=1) {
-				return LexItem(Token::ERR, errseq, linenum);
-			}
-			dotCount++;
-		}
-	}
+public:
+	BufferCursor(LexBuffer& buf) : buf(buf), start(buf.cur) {}
 
-	//if we reach here, its assumed that the sequence is a valid fconst or iconst
-	if (fconst) {
-		return LexItem(Token::FCONST, sequence, linenum);
-	}
-	else
-		return LexItem(Token::ICONST,sequence, linenum);
-}
+	int Peek() const { return buf.cur == buf.end ? -1 : (unsigned char)*buf.cur; }
+	void Next() { ++buf.cur; }
+	void Back() { --buf.cur; }
+	void Mark() { start = buf.cur; }
+	string Text() const { return string(start, buf.cur); }
+};
 
 /**
- * Function used to handle the *, which may be *
- * or **
+ * Cursor over an istream; consumed characters are kept for the lexeme
  */
-LexItem handle_star(istream &in, int& linenum) {
-	char inp = in.get();
-	char next = in.peek();
-	if (next == '*' && inp =='*') {
-		in.get();
-		return LexItem(Token::EXP, string("EXP"), linenum);
-	}
-	return LexItem(Token::MULT, string("MULT"), linenum);;
-}
+class StreamCursor {
+	istream& in;
+	string text;
 
-/**
- * Function used to handle the <, which may be <
- * or <=
- */
-LexItem handle_lessthan(istream &in, int& linenum) {
-	char first = in.get();
-	char next = in.peek();
-	if (next == '=' && first =='<') {
-		in.get();
-		return LexItem(Token::LTE, string("LTE"), linenum);
-	}
-	return LexItem(Token::LTHAN, string("LTHAN"), linenum);;
-}
+public:
+	StreamCursor(istream& in) : in(in) {}
 
-/**
- * Function used to handle the >, which may be >
- * or >=
- */
-LexItem handle_greaterthan(istream &in, int& linenum) {
-	char first = in.get();
-	char next = in.peek();
-	if (next == '=' && first =='>') {
-		in.get();
-		return LexItem(Token::GTE, string("GTE"), linenum);
-	}
-	return LexItem(Token::GTHAN, string("GTHAN"), linenum);;
-}
+	int Peek() const { return in.peek(); }
+	void Next() { text += (char)in.get(); }
+	void Back() { in.putback(text[text.length()-1]); text.resize(text.length()-1); }
+	void Mark() { text.clear(); }
+	string Text() const { return text; }
+};
 
 /**
- * Function used to handle the comments or minus
+ * Function used to build a numeric constant from the scanned sequence.
+ * A trailing 'e' or 'E' is put back and its place in the lexeme is left
+ * as '\0'; otherwise trailing dots are put back, which also makes the
+ * constant an integer. A second dot is an error.
  */
-LexItem handle_comments(istream &in, int& linenum) {
-	char first = in.peek();
-	char next = in.get();
-	string sequence = "";
-	//consecutive - signifies ,its a comment
-	if (next == '-' && first =='-') {
-		next = in.get();
-		//consume all the letters
-		while(next != '\n') {
-			sequence +=next;
-			next = in.get();
-
+template <class Cursor>
+static LexItem number(Cursor& in, int linenum) {
+	string sequence = in.Text();
+	bool fconst = sequence.find('.') != string::npos;
+	char last = sequence[sequence.length()-1];
+	if (last == 'e' || last == 'E') {
+		sequence[sequence.length()-1] = '\0';
+		in.Back();
+	}
+	else {
+		while (sequence[sequence.length()-1] == '.') {
+			sequence.resize(sequence.length()-1);
+			in.Back();
+			fconst = false;
 		}
-		linenum++;
-		return LexItem(Token::SCONST, sequence, linenum);;
 	}
-	in.putback(next); // we put back excess char here
-	return LexItem(Token::MINUS, string("MINUS"), linenum);;
-}
-
-/**
- * Function used to handle the colon, which may be colon
- * or ASSOP
- */
-LexItem handle_colon(istream &in, int& linenum) {
-	char first = in.get();
-	char next = in.peek();
-	if (next == '=' && first ==':') {
-		in.get();
-		return LexItem(Token::ASSOP, string("ASSOP"), linenum);
-	}
-	return LexItem(Token::COLON, string("COLON"), linenum);;
-}
 
-/**
- * Function used to handle the slash, which may be divide
- * or NEQ
- */
-LexItem handle_slash(istream &in, int& linenum) {
-	char first = in.get();
-	char next = in.peek();
-	if (next == '=' && first =='/') {
-		in.get();
-		return LexItem(Token::NEQ, string("NEQ"), linenum);
-	}
-	return LexItem(Token::DIV, string("DIV"), linenum);;
+	size_t dot = sequence.find('.');
+	if (dot != string::npos) {
+		size_t second = sequence.find('.', dot + 1);
+		if (second != string::npos)
+			return LexItem(Token::ERR, sequence.substr(0, second + 1), linenum);
+	}
+	if (fconst)
+		return LexItem(Token::FCONST, sequence, linenum);
+	return LexItem(Token::ICONST, sequence, linenum);
 }
 
 /**
- * Function used to retrieve the next token from the stream and
+ * Function used to retrieve the next token from the cursor and
  * construct the LexItem accordingly, handles the error lex items also
  */
-LexItem getNextToken(istream& in, int& linenum) {
-	char input;
-	// this loop is used to handle the spaces or new lines and comments
-	while (is_space(in.peek()) || in.peek() == '\n' || in.peek() == '-') {
-		input = in.get();
-		//in case a new line, just increment the count
-		if (input == '\n')
-			linenum++;
-		// hiphen signifies either a comment or minus
-		if (input == '-') {
-			LexItem item = handle_comments(in, linenum);
-			// we just ignore the comment string here, in order to distinguish
-			// comment from a minus symbol, we do so
-			if (item.GetToken() == Token::SCONST)
-				continue;
-			else
-				return item;
+template <class Cursor>
+static LexItem Scan(Cursor& in, int& linenum) {
+	unsigned char state = S_START;
+	int c;
+	for (;;) {
+		c = in.Peek();
+		unsigned char next = transitions[state][charClass[c + 1]];
+		if (next >= S_COUNT) {
+			state = next;
+			break;
 		}
-	}
+		in.Next();
+		// a new line that leads back to the start state ends a line
+		// of blanks or a comment
+		linenum += (next == S_START) & (c == '\n');
+		if (next == S_START)
+			in.Mark();
+		state = next;
+	}
+	if (consumes[state - A_DONE])
+		in.Next();
 
-	// at the end of file, we happen to find a -1 , which signifies done
-	int val = (int) in.peek();
-	if (val == -1) {
-		in.get();
+	string text;
+	switch (state) {
+	case A_DONE:
 		return LexItem(Token::DONE , "DONE", linenum);
-	}
-	//handle comma
-	if (in.peek() == ',') {
-		in.get();
-		return LexItem(Token::COMMA , "COMMA", linenum);
-	}
-
-	//handle others
-	switch (in.peek()) {
-	case 'a':
-	case 'b':
-	case 'c':
-	case 'd':
-	case 'e':
-	case 'f':
-	case 'g':
-	case 'h':
-	case 'i':
-	case 'j':
-	case 'k':
-	case 'l':
-	case 'm':
-	case 'n':
-	case 'o':
-	case 'p':
-	case 'q':
-	case 'r':
-	case 's':
-	case 't':
-	case 'u':
-	case 'v':
-	case 'w':
-	case 'x':
-	case 'y':
-	case 'z':
-	case 'A':
-	case 'B':
-	case 'C':
-	case 'D':
-	case 'E':
-	case 'F':
-	case 'G':
-	case 'H':
-	case 'I':
-	case 'J':
-	case 'K':
-	case 'L':
-	case 'M':
-	case 'N':
-	case 'O':
-	case 'P':
-	case 'Q':
-	case 'R':
-	case 'S':
-	case 'T':
-	case 'U':
-	case 'V':
-	case 'W':
-	case 'X':
-	case 'Y':
-	case 'Z':
-		return identifier(in, linenum);
-	case '0':
-	case '1':
-	case '2':
-	case '3':
-	case '4':
-	case '5':
-	case '6':
-	case '7':
-	case '8':
-	case '9':
-		return number(in,linenum);
-	case '(':
-		in.get();
-		return LexItem(Token::LPAREN , "LPAREN", linenum);
-	case ')':
-		in.get();
-		return LexItem(Token::RPAREN , "RPAREN", linenum);
-	case '<':
-		return handle_lessthan(in, linenum);
-	case '>':
-		return handle_greaterthan(in, linenum);
-	case '=':
-		in.get();
+	case A_ERRCHAR:
+		return LexItem(Token::ERR , string(1, (char)c), linenum);
+	case A_ID:
+		//convert to lower case , as its important to print in lowers
+		text = in.Text();
+		for (size_t i = 0; i < text.length(); i++)
+			text[i] = std::tolower(text[i]);
+		return id_or_kw(text, linenum);
+	case A_NUM:
+		return number(in, linenum);
+	case A_STR:
+		return LexItem(Token::SCONST, in.Text(), linenum);
+	case A_STRBAD:
+		// the new line that ended the string is left as '\0'
+		text = in.Text();
+		text[text.length()-1] = '\0';
+		return LexItem(Token::ERR, " Invalid string constant " + text, linenum);
+	case A_STREOF:
+		return LexItem(Token::ERR, " Invalid string constant " + in.Text() + '\0', linenum);
+	case A_CH:
+		return LexItem(Token::CCONST, in.Text().substr(1, 1), linenum);
+	case A_CHNL:
+		return LexItem(Token::ERR, "New line is an invalid character constant.",linenum);
+	case A_CHBAD:
+		return LexItem(Token::ERR, "Invalid character constant '" + in.Text().substr(1) + "'", linenum);
+	case A_CHEOF1:
+		return LexItem(Token::ERR, "Invalid character constant '\xFF\xFF'", linenum);
+	case A_CHEOF2:
+		return LexItem(Token::ERR, "Invalid character constant '" + in.Text().substr(1) + "\xFF'", linenum);
+	case A_MINUS:
+		return LexItem(Token::MINUS, "MINUS", linenum);
+	case A_MULT:
+		return LexItem(Token::MULT, "MULT", linenum);
+	case A_EXP:
+		return LexItem(Token::EXP, "EXP", linenum);
+	case A_LTHAN:
+		return LexItem(Token::LTHAN, "LTHAN", linenum);
+	case A_LTE:
+		return LexItem(Token::LTE, "LTE", linenum);
+	case A_GTHAN:
+		return LexItem(Token::GTHAN, "GTHAN", linenum);
+	case A_GTE:
+		return LexItem(Token::GTE, "GTE", linenum);
+	case A_COLON:
+		return LexItem(Token::COLON, "COLON", linenum);
+	case A_ASSOP:
+		return LexItem(Token::ASSOP, "ASSOP", linenum);
+	case A_DIV:
+		return LexItem(Token::DIV, "DIV", linenum);
+	case A_NEQ:
+		return LexItem(Token::NEQ, "NEQ", linenum);
+	case A_EQ:
 		return LexItem(Token::EQ , "EQ", linenum);
-	case '+':
-		in.get();
+	case A_PLUS:
 		return LexItem(Token::PLUS, "PLUS", linenum);
-	case '&':
-		in.get();
+	case A_CONCAT:
 		return LexItem(Token::CONCAT, "CONCAT", linenum);
-	case '*':
-		return handle_star(in,linenum);
-	case '.':
-		in.get();
+	case A_DOT:
 		return LexItem(Token::DOT , "DOT", linenum);
-	case '"':
-		return stringconst(in,linenum);
-	case '\'':
-		return charconst(in,linenum);
-	case ':':
-		return handle_colon(in, linenum);
-	case '/':
-		return handle_slash(in, linenum);
-	case ';':
-		in.get();
+	case A_LPAREN:
+		return LexItem(Token::LPAREN , "LPAREN", linenum);
+	case A_RPAREN:
+		return LexItem(Token::RPAREN , "RPAREN", linenum);
+	case A_SEMICOL:
 		return LexItem(Token::SEMICOL , "SEMICOL", linenum);
 	default:
-		string lexeme;
-		lexeme.push_back(in.peek());
-		return LexItem(Token::ERR , lexeme, linenum);
+		return LexItem(Token::COMMA , "COMMA", linenum);
 	}
 }
 
+LexItem getNextToken(istream& in, int& linenum) {
+	StreamCursor cursor(in);
+	return Scan(cursor, linenum);
+}
+
+LexItem getNextToken(LexBuffer& in, int& linenum) {
+	BufferCursor cursor(in);
+	return Scan(cursor, linenum);
+}
+
 /**
  * Overloaded Function used to print the given token
  */
@@ -589,82 +443,110 @@ ostream& operator<<(ostream& out, const LexItem& tok) {
 
 /**
  * Function used to check whether the given lexeme is
- * an id or keyword
+ * an id or keyword; the lexeme is already in lower case.
+ * Keywords are picked by length and then by first letter, so
+ * an identifier is compared against at most three of them
  */
+static bool KwEq(const string& lexeme, const char* kw) {
+	return memcmp(lexeme.data(), kw, lexeme.length()) == 0;
+}
+
 LexItem id_or_kw(const string& lexeme, int linenum) {
-	if (lexeme == "if") {
-		return LexItem(Token::IF,"if", linenum);
-	}
-	else if (lexeme == "else") {
-		return LexItem(Token::ELSE,"else", linenum);
-	}
-	else if (lexeme == "elsif") {
-		return LexItem(Token::ELSIF,"ELSIF", linenum);
-	}
-	else if (lexeme == "put") {
-		return LexItem(Token::PUT,"put", linenum);
-	}
-	else if (lexeme == "putline") {
-		return LexItem(Token::PUTLN,"putline", linenum);
-	}
-	else if (lexeme == "integer") {
-		return LexItem(Token::INT,"integer", linenum);
-	}
-	else if (lexeme == "character") {
-		return LexItem(Token::CHAR,"char", linenum);
-	}
-	else if (lexeme == "float") {
-		return LexItem(Token::FLOAT,"float", linenum);
-	}
-	else if (lexeme == "string") {
-		return LexItem(Token::STRING,"string", linenum);
-	}
-	else if (lexeme == "boolean") {
-		return LexItem(Token::BOOL,"boolean", linenum);
-	}
-	else if (lexeme == "procedure") {
-		return LexItem(Token::PROCEDURE,"procedure", linenum);
-	}
-	else if (lexeme == "end") {
-		return LexItem(Token::END,"end", linenum);
-	}
-	else if (lexeme == "is") {
-		return LexItem(Token::IS,"is", linenum);
-	}
-	else if (lexeme == "begin") {
-		return LexItem(Token::BEGIN,"begin", linenum);
-	}
-	else if (lexeme == "get") {
-		return LexItem(Token::GET,"get", linenum);
-	}
-	else if (lexeme == "true") {
-		return LexItem(Token::BCONST,"true", linenum);
-	}
-	else if (lexeme == "false") {
-		return LexItem(Token::BCONST,"false", linenum);
-	}
-	else if (lexeme == "constant") {
-		return LexItem(Token::CONST,"const", linenum);
-	}
-	else if (lexeme == "mod") {
-		return LexItem(Token::MOD,"mod", linenum);
-	}
-	else if (lexeme == "and") {
-		return LexItem(Token::AND,"and", linenum);
-	}
-	else if (lexeme == "or") {
-		return LexItem(Token::OR,"or", linenum);
-	}
-	else if (lexeme == "not") {
-		return LexItem(Token::NOT,"not", linenum);
-	}
-	else if (lexeme == "then") {
-		return LexItem(Token::THEN,"then", linenum);
-	}
-	else if (lexeme == "done") {
-		return LexItem(Token::DONE,"done", linenum);
-	}
-	else{
-		return LexItem(Token::IDENT,lexeme, linenum);
-	}
+	switch (lexeme.length()) {
+	case 2:
+		if (KwEq(lexeme, "if"))
+			return LexItem(Token::IF,"if", linenum);
+		if (KwEq(lexeme, "is"))
+			return LexItem(Token::IS,"is", linenum);
+		if (KwEq(lexeme, "or"))
+			return LexItem(Token::OR,"or", linenum);
+		break;
+	case 3:
+		switch (lexeme[0]) {
+		case 'p':
+			if (KwEq(lexeme, "put"))
+				return LexItem(Token::PUT,"put", linenum);
+			break;
+		case 'e':
+			if (KwEq(lexeme, "end"))
+				return LexItem(Token::END,"end", linenum);
+			break;
+		case 'g':
+			if (KwEq(lexeme, "get"))
+				return LexItem(Token::GET,"get", linenum);
+			break;
+		case 'm':
+			if (KwEq(lexeme, "mod"))
+				return LexItem(Token::MOD,"mod", linenum);
+			break;
+		case 'a':
+			if (KwEq(lexeme, "and"))
+				return LexItem(Token::AND,"and", linenum);
+			break;
+		case 'n':
+			if (KwEq(lexeme, "not"))
+				return LexItem(Token::NOT,"not", linenum);
+			break;
+		}
+		break;
+	case 4:
+		if (KwEq(lexeme, "else"))
+			return LexItem(Token::ELSE,"else", linenum);
+		if (KwEq(lexeme, "true"))
+			return LexItem(Token::BCONST,"true", linenum);
+		if (KwEq(lexeme, "then"))
+			return LexItem(Token::THEN,"then", linenum);
+		if (KwEq(lexeme, "done"))
+			return LexItem(Token::DONE,"done", linenum);
+		break;
+	case 5:
+		switch (lexeme[0]) {
+		case 'e':
+			if (KwEq(lexeme, "elsif"))
+				return LexItem(Token::ELSIF,"ELSIF", linenum);
+			break;
+		case 'f':
+			if (KwEq(lexeme, "float"))
+				return LexItem(Token::FLOAT,"float", linenum);
+			if (KwEq(lexeme, "false"))
+				return LexItem(Token::BCONST,"false", linenum);
+			break;
+		case 'b':
+			if (KwEq(lexeme, "begin"))
+				return LexItem(Token::BEGIN,"begin", linenum);
+			break;
+		}
+		break;
+	case 6:
+		if (KwEq(lexeme, "string"))
+			return LexItem(Token::STRING,"string", linenum);
+		break;
+	case 7:
+		switch (lexeme[0]) {
+		case 'p':
+			if (KwEq(lexeme, "putline"))
+				return LexItem(Token::PUTLN,"putline", linenum);
+			break;
+		case 'i':
+			if (KwEq(lexeme, "integer"))
+				return LexItem(Token::INT,"integer", linenum);
+			break;
+		case 'b':
+			if (KwEq(lexeme, "boolean"))
+				return LexItem(Token::BOOL,"boolean", linenum);
+			break;
+		}
+		break;
+	case 8:
+		if (KwEq(lexeme, "constant"))
+			return LexItem(Token::CONST,"const", linenum);
+		break;
+	case 9:
+		if (KwEq(lexeme, "character"))
+			return LexItem(Token::CHAR,"char", linenum);
+		if (KwEq(lexeme, "procedure"))
+			return LexItem(Token::PROCEDURE,"procedure", linenum);
+		break;
+	}
+	return LexItem(Token::IDENT,lexeme, linenum);
 }
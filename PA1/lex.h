@@ -63,10 +63,32 @@ public:
 };
 
 
+//Contiguous source text for the buffer-based lexer.
+//The text is not owned and must outlive the buffer.
+class LexBuffer {
+	const char*	cur;
+	const char*	end;
+
+	friend class BufferCursor;
+
+public:
+	LexBuffer(const char* text, size_t len) {
+		cur = text;
+		end = text + len;
+	}
+	LexBuffer(const string& text) {
+		cur = text.data();
+		end = text.data() + text.size();
+	}
+
+	bool	eof() const { return cur == end; }
+};
+
 
 extern ostream& operator<<(ostream& out, const LexItem& tok);
 extern LexItem id_or_kw(const string& lexeme, int linenum);
 extern LexItem getNextToken(istream& in, int& linenum);
+extern LexItem getNextToken(LexBuffer& in, int& linenum);
 
 
 #endif /* LEX_H_ */
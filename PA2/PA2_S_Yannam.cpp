@@ -5,30 +5,27 @@
  * Spring 2025
  */
 #include <queue>
+#include <sstream>
 #include "parser.h"
+#include "tokstream.h"
 
 
 map<string, bool> defVar;
 
 namespace Parser {
-bool pushed_back = false;
-LexItem	pushed_token;
+TokenStream tokens;
 
 static LexItem GetNextToken(istream& in, int& line) {
-	if( pushed_back ) {
-		pushed_back = false;
-		return pushed_token;
-	}
-	LexItem result = getNextToken(in, line);
-	return result;
+	return tokens.Get(in, line);
 }
 
-static void PushBackToken(LexItem & t) {
-	if( pushed_back ) {
-		abort();
-	}
-	pushed_back = true;
-	pushed_token = t;
+//The token k places after the next one, left in the stream
+static LexItem PeekToken(istream& in, int line, unsigned k = 0) {
+	return tokens.Peek(in, line, k);
+}
+
+static void PushBackToken(const LexItem & t) {
+	tokens.PushBack(t);
 }
 
 }
@@ -71,19 +68,15 @@ bool StmtList(istream& in, int& line)
 //DeclPart ::= DeclStmt { DeclStmt }
 bool DeclPart(istream& in, int& line) {
 	bool status = false;
-	LexItem tok;
 	status = DeclStmt(in, line);
 	if(status)
 	{
-		tok = Parser::GetNextToken(in, line);
-		if(tok == BEGIN )
+		if(Parser::PeekToken(in, line) == BEGIN )
 		{
-			Parser::PushBackToken(tok);
 			return true;
 		}
 		else
 		{
-			Parser::PushBackToken(tok);
 			status = DeclPart(in, line);
 		}
 	}
@@ -134,6 +127,15 @@ bool Prog(istream& in, int& line) {
 	return true;
 }
 
+//Parse a program lexed up front; the stream is never read
+bool Prog(const TokenArray& tokens, int& line) {
+	istringstream unused;
+	Parser::tokens.Attach(&tokens);
+	bool status = Prog(unused, line);
+	Parser::tokens.Clear();
+	return status;
+}
+
 bool ProcBody(istream& in, int& line) {
 	bool result = DeclPart(in,line);
 	LexItem item;
@@ -273,19 +275,18 @@ bool Type(istream& in, int& line){
 
 
 bool Stmt(istream& in, int& line){
-	if (AssignStmt(in,line)) {
-		return true;
-	}
-	else if (PrintStmts(in,line)) {
-		return true;
-	}
-	else if (GetStmt(in,line)) {
-		return true;
-	}
-	else if (IfStmt(in,line)) {
-		return true;
-	}
-	else {
+	//the first token decides the statement, so only one is tried
+	switch (Parser::PeekToken(in,line).GetToken()) {
+	case IDENT:
+		return AssignStmt(in,line);
+	case PUT:
+	case PUTLN:
+		return PrintStmts(in,line);
+	case GET:
+		return GetStmt(in,line);
+	case IF:
+		return IfStmt(in,line);
+	default:
 		return false;
 	}
 }
@@ -6,43 +6,86 @@
 
  #include <cctype>
  #include <map>
+ #include <sstream>
  
  using std::map;
  using namespace std;
  
  #include "lex.h"
- //Keywords or reserved words mapping
- LexItem id_or_kw(const string& lexeme , int linenum)
+ //Case-insensitive match of an identifier against a lower-case keyword of
+ //the same length
+ static bool KwEq(const char* s, const char* kw, size_t len)
  {
-     string strlexeme = lexeme;
-     map<string,Token> kwmap = {
-         { "put", PUT}, { "putline", PUTLN}, { "get", GET},
-         { "if", IF }, { "elsif", ELSIF }, 
-         { "else", ELSE },
-         { "string", STRING },
-         { "integer", INT },
-         { "float", FLOAT },
-         { "character", CHAR },
-         { "boolean", BOOL },
-         { "procedure", PROCEDURE }, { "begin", BEGIN },
-         { "true", TRUE }, { "then", THEN }, { "constant", CONST },
-         { "false", FALSE }, { "is", IS }, { "end", END },
-         { "mod", MOD }, { "and", AND }, { "or", OR }, { "not", NOT },
-         
-     };
-     Token tt ;
-     
-     for(int i = 0; i < lexeme.length(); i++)
+     for(size_t i = 0; i < len; i++)
      {
-         strlexeme[i] = tolower(strlexeme[i]);
+         if( tolower((unsigned char) s[i]) != kw[i] )
+             return false;
      }
+     return true;
+ }
+ 
+ //Keywords or reserved words, picked by length and then by first letter
+ //so classifying an identifier never allocates
+ static Token Keyword(const string& lexeme)
+ {
+     const char* s = lexeme.data();
+     size_t len = lexeme.length();
      
-     tt = IDENT;
-     auto kIt = kwmap.find(strlexeme);
-     if( kIt != kwmap.end() )
-     {
-         tt = kIt->second;
+     switch( len ) {
+     case 2:
+         if( KwEq(s, "if", len) ) return IF;
+         if( KwEq(s, "is", len) ) return IS;
+         if( KwEq(s, "or", len) ) return OR;
+         break;
+     case 3:
+         switch( tolower((unsigned char) s[0]) ) {
+         case 'p': if( KwEq(s, "put", len) ) return PUT; break;
+         case 'g': if( KwEq(s, "get", len) ) return GET; break;
+         case 'e': if( KwEq(s, "end", len) ) return END; break;
+         case 'm': if( KwEq(s, "mod", len) ) return MOD; break;
+         case 'a': if( KwEq(s, "and", len) ) return AND; break;
+         case 'n': if( KwEq(s, "not", len) ) return NOT; break;
+         }
+         break;
+     case 4:
+         if( KwEq(s, "else", len) ) return ELSE;
+         if( KwEq(s, "then", len) ) return THEN;
+         if( KwEq(s, "true", len) ) return TRUE;
+         break;
+     case 5:
+         switch( tolower((unsigned char) s[0]) ) {
+         case 'e': if( KwEq(s, "elsif", len) ) return ELSIF; break;
+         case 'b': if( KwEq(s, "begin", len) ) return BEGIN; break;
+         case 'f':
+             if( KwEq(s, "float", len) ) return FLOAT;
+             if( KwEq(s, "false", len) ) return FALSE;
+             break;
+         }
+         break;
+     case 6:
+         if( KwEq(s, "string", len) ) return STRING;
+         break;
+     case 7:
+         switch( tolower((unsigned char) s[0]) ) {
+         case 'p': if( KwEq(s, "putline", len) ) return PUTLN; break;
+         case 'i': if( KwEq(s, "integer", len) ) return INT; break;
+         case 'b': if( KwEq(s, "boolean", len) ) return BOOL; break;
+         }
+         break;
+     case 8:
+         if( KwEq(s, "constant", len) ) return CONST;
+         break;
+     case 9:
+         if( KwEq(s, "character", len) ) return CHAR;
+         if( KwEq(s, "procedure", len) ) return PROCEDURE;
+         break;
      }
+     return IDENT;
+ }
+ 
+ LexItem id_or_kw(const string& lexeme , int linenum)
+ {
+     Token tt = Keyword(lexeme);
      
      if(tt == TRUE || tt == FALSE)	
          tt = BCONST;
@@ -442,6 +485,86 @@
      return LexItem(ERR, "Error: Some strange symbol", linenum);
  }
  
+ unsigned TokenArray::Name(const string& lexeme)
+ {
+     unordered_map<string, unsigned>::iterator it = interned.find(lexeme);
+     if( it == interned.end() )
+     {
+         it = interned.insert(make_pair(lexeme, (unsigned)names.size())).first;
+         names.push_back(lexeme);
+     }
+     return it->second;
+ }
+ 
+ void TokenArray::Add(const LexItem& tok, unsigned offset, int line)
+ {
+     //operators and keywords repeat the lexeme of their kind, so that is
+     //tried before the table
+     Token kind = tok.GetToken();
+     unsigned& last = lastName[kind];
+     if( last == (unsigned)-1 || names[last] != tok.GetLexeme() )
+         last = Name(tok.GetLexeme());
+     kinds.push_back((unsigned char)kind);
+     offsets.push_back(offset);
+     lines.push_back(line);
+     ids.push_back(last);
+ }
+ 
+ void TokenArray::Clear()
+ {
+     for( int i = 0; i <= DONE; i++ )
+         lastName[i] = (unsigned)-1;
+     kinds.clear();
+     offsets.clear();
+     lines.clear();
+     ids.clear();
+     names.clear();
+     interned.clear();
+ }
+ 
+ //Stream buffer reading straight out of text already in memory, which
+ //can say where it is without seeking
+ class TextBuf : public streambuf {
+ public:
+     TextBuf(const string& text) {
+         char* p = const_cast<char*>(text.data());
+         setg(p, p, p + text.size());
+     }
+     size_t Pos() const { return gptr() - eback(); }
+ };
+ 
+ void Tokenize(const string& text, int& linenum, TokenArray& tokens)
+ {
+     TextBuf buf(text);
+     istream in(&buf);
+     //room for a token every four bytes; denser sources grow the arrays
+     size_t guess = text.size() / 4 + 1;
+     tokens.Clear();
+     tokens.kinds.reserve(guess);
+     tokens.offsets.reserve(guess);
+     tokens.lines.reserve(guess);
+     tokens.ids.reserve(guess);
+     
+     //lexing goes on after an error, as it would if the parser asked for
+     //more tokens, unless the lexer is stuck on it
+     for( ;; )
+     {
+         size_t before = buf.Pos();
+         LexItem tok = getNextToken(in, linenum);
+         tokens.Add(tok, (unsigned)buf.Pos(), linenum);
+         if( tok == DONE || (tok == ERR && buf.Pos() == before) )
+             break;
+     }
+ }
+ 
+ void Tokenize(istream& in, int& linenum, TokenArray& tokens)
+ {
+     //read the rest of the stream once; asking a file stream for its
+     //position after every token would make it seek each time
+     ostringstream whole;
+     whole << in.rdbuf();
+     Tokenize(whole.str(), linenum, tokens);
+ }
  
  
  
@@ -11,6 +11,8 @@
 #include <string>
 #include <iostream>
 #include <map>
+#include <unordered_map>
+#include <vector>
 using namespace std;
 
 
@@ -48,7 +50,7 @@ public:
 		token = ERR;
 		lnum = -1;
 	}
-	LexItem(Token token, string lexeme, int line) {
+	LexItem(Token token, const string& lexeme, int line) {
 		this->token = token;
 		this->lexeme = lexeme;
 		this->lnum = line;
@@ -58,15 +60,45 @@ public:
 	bool operator!=(const Token token) const { return this->token != token; }
 
 	Token	GetToken() const { return token; }
-	string	GetLexeme() const { return lexeme; }
+	const string& GetLexeme() const { return lexeme; }
 	int	GetLinenum() const { return lnum; }
 };
 
 
 
+//A whole source lexed up front, one entry per token, kept as parallel
+//arrays so the parser can walk it by index. Each distinct lexeme is kept
+//once, in names. The last entry is DONE, or an ERR the lexer could not
+//get past.
+class TokenArray {
+	unordered_map<string, unsigned> interned;
+	unsigned lastName[DONE + 1];	// id last added for each kind, or -1
+
+public:
+	vector<unsigned char> kinds;	// Token
+	vector<unsigned> offsets;	// source offset just past the token
+	vector<int>	lines;		// line count after the token
+	vector<unsigned> ids;		// index into names
+	vector<string>	names;
+
+	TokenArray() { Clear(); }
+
+	size_t	Size() const { return kinds.size(); }
+	LexItem	Item(size_t i) const { return LexItem((Token)kinds[i], names[ids[i]], lines[i]); }
+	//Index of lexeme in names, adding it if it is new
+	unsigned Name(const string& lexeme);
+	void	Add(const LexItem& tok, unsigned offset, int line);
+	void	Clear();
+};
+
+
 extern ostream& operator<<(ostream& out, const LexItem& tok);
 extern LexItem id_or_kw(const string& lexeme, int linenum);
 extern LexItem getNextToken(istream& in, int& linenum);
+//Lex all of in into tokens, up to and including DONE
+extern void Tokenize(istream& in, int& linenum, TokenArray& tokens);
+//The same for source text already in memory
+extern void Tokenize(const string& text, int& linenum, TokenArray& tokens);
 
 
 #endif /* LEX_H_ */
@@ -14,6 +14,7 @@ using namespace std;
 #include "lex.h"
 
 extern bool Prog(istream& in, int& line);
+extern bool Prog(const TokenArray& tokens, int& line);
 extern bool ProcBody(istream& in, int& line);
 extern bool DeclPart(istream& in, int& line);
 extern bool DeclStmt(istream& in, int& line);
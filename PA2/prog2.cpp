@@ -9,6 +9,7 @@
 
 #include "lex.h"
 #include "parser.h"
+#include "tokcache.h"
 
 
 using namespace std;
@@ -20,12 +21,30 @@ int main(int argc, char *argv[])
 
 	istream *in = NULL;
 	ifstream file;
+	bool lexFirst = false;
+	string tokenCache;
 		
 	for( int i=1; i<argc; i++ )
     {
 		string arg = argv[i];
 		
-		if( in != NULL ) 
+		if( arg == "-lexfirst" )
+		{
+			//lex the whole file before parsing and walk the tokens by index
+			lexFirst = true;
+		}
+		else if( arg == "-tokcache" )
+		{
+			//reuse the tokens of sources lexed before, keyed by their text
+			if( ++i == argc )
+			{
+				cerr << "Missing Token Cache Directory." << endl;
+				return 0;
+			}
+			tokenCache = argv[i];
+			lexFirst = true;
+		}
+		else if( in != NULL ) 
         {
 			cerr << "ONLY ONE FILE NAME ALLOWED" << endl;
 			return 0;
@@ -42,13 +61,25 @@ int main(int argc, char *argv[])
 			in = &file;
 		}
 	}
-	if(argc == 1)
+	if( in == NULL )
 	{
 		cerr << "Missing File Name." << endl;
 		return 0;
 	}
     //cout << "before entering parser" << endl;
-    bool status = Prog(*in, lineNumber);
+    bool status;
+    if( lexFirst )
+    {
+    	TokenArray tokens;
+    	int lexLine = lineNumber;
+    	if( tokenCache.empty() )
+    		Tokenize(*in, lexLine, tokens);
+    	else
+    		CachedTokenize(tokenCache, *in, lexLine, tokens);
+    	status = Prog(tokens, lineNumber);
+    }
+    else
+    	status = Prog(*in, lineNumber);
     //cout << "returned from parser" << endl;
     if( !status )
     {
@@ -0,0 +1,62 @@
+/*
+ * tokcache.cpp
+ * On-disk cache of lexed SADAL sources
+ * CS280 - Spring 2025
+ */
+
+#include <sstream>
+
+#include "tokcache.h"
+#include "../PA3/tokfile.h"
+
+static const char Magic[8] = { 'S', 'A', 'D', 'A', 'L', 'T', 'K', '2' };
+
+//Move a loaded file into tokens, with lines counted on from linenum; false
+//if it does not check out
+static bool Restore(TokenFile& file, int& linenum, TokenArray& tokens)
+{
+	if( file.kinds.back() != DONE )
+		return false;
+	tokens.Clear();
+	//the file's names are distinct, so they keep their indexes
+	for( size_t i = 0; i < file.names.size(); i++ )
+	{
+		if( tokens.Name(file.names[i]) != i )
+			return false;
+	}
+	tokens.kinds.swap(file.kinds);
+	tokens.offsets.swap(file.offsets);
+	tokens.lines.swap(file.lines);
+	tokens.ids.swap(file.ids);
+	for( size_t i = 0; i < tokens.lines.size(); i++ )
+		tokens.lines[i] += linenum;
+	linenum = tokens.lines.back();
+	return true;
+}
+
+bool CachedTokenize(const string& dir, istream& in, int& linenum, TokenArray& tokens)
+{
+	//the stream is read whole to hash it, and lexed from memory on a miss
+	ostringstream whole;
+	whole << in.rdbuf();
+	string text = whole.str();
+	string path = TokenFilePath(dir, SourceHash(text.data(), text.size()), ".tok2");
+
+	TokenFile file;
+	if( LoadTokenFile(path, Magic, DONE + 1, text.data(), text.size(), file) && Restore(file, linenum, tokens) )
+		return true;
+
+	//lex from line 0 so the file does not depend on where counting starts
+	int counted = 0;
+	Tokenize(text, counted, tokens);
+	file.kinds = tokens.kinds;
+	file.offsets = tokens.offsets;
+	file.lines = tokens.lines;
+	file.ids = tokens.ids;
+	file.names = tokens.names;
+	SaveTokenFile(dir, path, Magic, DONE + 1, text.data(), text.size(), file);
+	for( size_t i = 0; i < tokens.lines.size(); i++ )
+		tokens.lines[i] += linenum;
+	linenum += counted;
+	return false;
+}
@@ -0,0 +1,27 @@
+/*
+ * tokcache.h
+ * On-disk cache of lexed SADAL sources
+ *
+ * CS280 - Spring 2025
+ *
+ * A source lexed once is saved to the cache directory under a name taken
+ * from a hash of its text, and lexing the same text again reads that file
+ * instead of running the lexer. The file format, and the checks that make
+ * a changed or colliding source miss, are those of prog3's cache in
+ * ../PA3/tokfile.h; the two parsers keep their files apart.
+*/
+
+#ifndef TOKCACHE_H_
+#define TOKCACHE_H_
+
+#include <string>
+
+#include "lex.h"
+
+using namespace std;
+
+//Tokenize(in, linenum, tokens) through the cache in dir; true when the
+//tokens came from the cache
+extern bool CachedTokenize(const string& dir, istream& in, int& linenum, TokenArray& tokens);
+
+#endif /* TOKCACHE_H_ */
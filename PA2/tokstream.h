@@ -0,0 +1,131 @@
+/*
+ * tokstream.h
+ * Token lookahead for the SADAL parser
+ *
+ * CS280 - Spring 2025
+ *
+ * A TokenStream keeps the last Size tokens lexed in a ring. The parser
+ * takes them in order with Get(), looks any number of tokens ahead with
+ * Peek() without taking them, and steps back over tokens it has taken
+ * with PushBack() or Rewind() as long as they are still in the ring.
+ * Tokens are lexed once, when first needed.
+ *
+ * Each slot also keeps the lexer's line count after its token. Get() sets
+ * the caller's line to it, so line numbers come out as if every token had
+ * been lexed at the moment it was taken, however far ahead Peek() read.
+ *
+ * With a TokenArray attached the stream lexes nothing: it walks the array
+ * by index, the stream passed in is ignored, and every token stays
+ * reachable by PushBack() and Rewind(). Reading past the end keeps
+ * returning the array's last token.
+*/
+
+#ifndef TOKSTREAM_H_
+#define TOKSTREAM_H_
+
+#include <cstdlib>
+
+#include "lex.h"
+
+class TokenStream {
+public:
+	static const unsigned Size = 16;	// a power of two
+
+private:
+	struct Slot {
+		LexItem	tok;
+		int	line;
+	};
+
+	Slot	ring[Size];
+	unsigned next;			// sequence number of the token Get() returns next
+	unsigned end;			// one past the last token lexed
+
+	const TokenArray* array;	// tokens lexed up front, or NULL
+	size_t	pos;			// index of the token Get() returns next
+
+	size_t	Last() const { return array->Size() - 1; }
+
+	Slot& At(unsigned seq) { return ring[seq & (Size - 1)]; }
+
+	//Lex one more token into the ring, counting lines on from line
+	void Fill(istream& in, int line) {
+		Slot& s = At(end++);
+		s.line = line;
+		s.tok = getNextToken(in, s.line);
+	}
+
+public:
+	TokenStream() : next(0), end(0), array(NULL), pos(0) {}
+
+	//Forget every token; the next one is lexed from the stream
+	void Clear() { next = end = 0; array = NULL; }
+
+	//Walk tokens, which must outlive the stream, from the start; NULL
+	//goes back to lexing from the stream
+	void Attach(const TokenArray* tokens) {
+		Clear();
+		array = tokens;
+		pos = 0;
+	}
+
+	//Take the next token
+	LexItem Get(istream& in, int& line) {
+		if( array )
+		{
+			size_t i = pos <= Last() ? pos++ : Last();
+			line = array->lines[i];
+			return array->Item(i);
+		}
+		if( next == end )
+			Fill(in, line);
+		Slot& s = At(next++);
+		line = s.line;
+		return s.tok;
+	}
+
+	//The token k places after the next one, without taking it; line is
+	//only read, to number any lines lexed ahead
+	LexItem Peek(istream& in, int line, unsigned k = 0) {
+		if( array )
+			return array->Item(pos + k < Last() ? pos + k : Last());
+		if( k >= Size )
+			abort();
+		while( end - next <= k )
+			Fill(in, next == end ? line : At(end - 1).line);
+		return At(next + k).tok;
+	}
+
+	//Step back one token, so that the next Get() returns t; t is
+	//normally the token taken last, but need not be
+	void PushBack(const LexItem& t) {
+		if( array )
+		{
+			//the array cannot hold t; it must be the token taken last
+			if( pos == 0 )
+				abort();
+			pos--;
+			return;
+		}
+		if( end - next >= Size )
+			abort();
+		At(--next).tok = t;
+	}
+
+	//Position to come back to with Rewind()
+	size_t Mark() const { return array ? pos : next; }
+
+	//Give back every token taken since Mark() returned mark
+	void Rewind(size_t mark) {
+		if( array )
+		{
+			pos = mark;
+			return;
+		}
+		if( end - (unsigned)mark > Size )
+			abort();
+		next = (unsigned)mark;
+	}
+};
+
+#endif /* TOKSTREAM_H_ */
@@ -0,0 +1,121 @@
+/*
+ * bench.h
+ * Shared helpers for the lexer, parser and interpreter benchmarks
+ *
+ * CS280 - Spring 2025
+ *
+ * Each benchmark loads a workload written by gensadal, times one phase
+ * and prints one line per measurement:
+ *
+ *   <phase> items=<n> <unit>/s=<rate> seconds=<best> peak_kb=<rss>
+ *
+ * The time is the best of the repeats. peak_kb is the peak resident set
+ * of the whole process, so run one phase per process when comparing
+ * memory.
+*/
+
+#ifndef BENCH_H_
+#define BENCH_H_
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <cstdlib>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#define BENCH_HAVE_RUSAGE 1
+#endif
+
+using namespace std;
+
+//A benchmark program and what gensadal recorded about it
+struct Workload {
+	string	text;
+	string	shape;
+	long	statements;
+
+	Workload() : statements(0) {}
+};
+
+//Read path into w; the statement count comes from the gensadal header
+//line, or stays 0 for programs written by hand
+static bool LoadWorkload(const char* path, Workload& w)
+{
+	ifstream file(path, ios::in | ios::binary);
+	if( !file.is_open() )
+		return false;
+	ostringstream text;
+	text << file.rdbuf();
+	w.text = text.str();
+
+	string header = w.text.substr(0, w.text.find('\n'));
+	size_t shape = header.find("shape=");
+	size_t count = header.find("statements=");
+	if( header.compare(0, 11, "-- gensadal") == 0 && shape != string::npos && count != string::npos )
+	{
+		w.shape = header.substr(shape + 6, header.find(' ', shape) - shape - 6);
+		w.statements = atol(header.c_str() + count + 11);
+	}
+	return true;
+}
+
+typedef chrono::steady_clock BenchClock;
+
+static double Seconds(BenchClock::time_point start)
+{
+	return chrono::duration<double>(BenchClock::now() - start).count();
+}
+
+//Peak resident set of the process so far, in KB; 0 where unknown
+static long PeakKB()
+{
+#ifdef BENCH_HAVE_RUSAGE
+	struct rusage usage;
+	if( getrusage(RUSAGE_SELF, &usage) == 0 )
+	{
+#ifdef __APPLE__
+		return usage.ru_maxrss / 1024;
+#else
+		return usage.ru_maxrss;
+#endif
+	}
+#endif
+	return 0;
+}
+
+static void Report(const string& phase, long items, const char* unit, double seconds)
+{
+	cout << phase << " items=" << items << " " << unit << "/s=";
+	if( seconds > 0 )
+		cout << (long) (items / seconds);
+	else
+		cout << "inf";
+	cout << " seconds=" << seconds << " peak_kb=" << PeakKB() << endl;
+}
+
+//Number of timed runs from -repeat n, default 3
+static int Repeats(int argc, char *argv[])
+{
+	for( int i = 1; i + 1 < argc; i++ )
+	{
+		if( string(argv[i]) == "-repeat" )
+			return atoi(argv[i + 1]) > 0 ? atoi(argv[i + 1]) : 1;
+	}
+	return 3;
+}
+
+//Value of -mode, or def when it is not given
+static string Mode(int argc, char *argv[], const string& def)
+{
+	for( int i = 1; i + 1 < argc; i++ )
+	{
+		if( string(argv[i]) == "-mode" )
+			return argv[i + 1];
+	}
+	return def;
+}
+
+#endif /* BENCH_H_ */
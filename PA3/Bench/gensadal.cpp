@@ -0,0 +1,199 @@
+/*
+ * gensadal.cpp
+ * Workload generator for the lexer, parser and interpreter benchmarks
+ *
+ * CS280 - Spring 2025
+ *
+ * Writes a clean SADAL procedure of the requested shape to standard
+ * output. Every shape only uses variables it has declared and assigned,
+ * never calls GET, and keeps values small, so the program runs to
+ * completion under prog3. The first line is a comment with the shape and
+ * the number of statements, which the benchmarks read back to report
+ * statements per second.
+ *
+ *   g++ -std=c++11 -O2 gensadal.cpp -o gensadal
+ *   ./gensadal [-shape expr|decls|ifs|concat|comments|mixed]
+ *              [-size statements] [-depth nesting] [-seed n] > prog.ada
+ */
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <cstdlib>
+
+using namespace std;
+
+//Variables every shape may use; all are declared with a value
+static const int IntVars = 8;
+
+struct Gen {
+	ostringstream body;
+	long statements;
+	int depth;
+
+	Gen(int d) : statements(0), depth(d) {}
+
+	string Int(int i) const { ostringstream s; s << "n" << (i % IntVars); return s.str(); }
+
+	void Indent(int level) {
+		for( int i = 0; i < level; i++ )
+			body << "   ";
+	}
+
+	//An integer expression nested depth levels deep; the mod keeps the
+	//value from growing from one statement to the next
+	string Expr(int level) {
+		if( level <= 0 )
+			return Int(rand());
+		static const char* ops[] = { " + ", " - ", " * " };
+		ostringstream e;
+		e << "(" << Expr(level - 1) << ops[rand() % 3] << (rand() % 9 + 1) << ")";
+		return e.str();
+	}
+
+	void Assign(int level) {
+		Indent(level);
+		body << Int(rand()) << " := " << Expr(depth) << " mod 97;\n";
+		statements++;
+	}
+
+	void Print(int level) {
+		Indent(level);
+		body << "putline(\"" << Int(rand()) << " = \" & s);\n";
+		statements++;
+	}
+
+	void Concat(int level, long i) {
+		Indent(level);
+		//start over now and then so the string stays short
+		if( i % 64 == 0 )
+			body << "s := \"start\";\n";
+		else
+			body << "s := s & \"-\" & t;\n";
+		statements++;
+	}
+
+	void Comment(int level) {
+		for( int i = 0; i < depth; i++ )
+		{
+			Indent(level);
+			body << "-- commentary line " << i << " that the lexer has to skip over, "
+				<< "written the way long explanatory comments usually are\n";
+		}
+	}
+
+	//IF with two ELSIF arms and an ELSE, nested depth levels deep in each arm
+	void If(int level, int nest) {
+		Indent(level);
+		body << "if " << Int(rand()) << " > " << rand() % 97 << " then\n";
+		statements++;
+		Arm(level, nest);
+		Indent(level);
+		body << "elsif " << Int(rand()) << " = " << rand() % 97 << " and flag then\n";
+		Arm(level, nest);
+		Indent(level);
+		body << "elsif not flag or " << Int(rand()) << " < 10 then\n";
+		Arm(level, nest);
+		Indent(level);
+		body << "else\n";
+		Arm(level, nest);
+		Indent(level);
+		body << "end if;\n";
+	}
+
+	void Arm(int level, int nest) {
+		if( nest > 1 )
+			If(level + 1, nest - 1);
+		Assign(level + 1);
+	}
+};
+
+int main(int argc, char *argv[])
+{
+	string shape = "mixed";
+	long size = 10000;
+	int depth = 8;
+	unsigned seed = 280;
+
+	for( int i = 1; i < argc; i++ )
+	{
+		string arg = argv[i];
+		if( i + 1 == argc )
+		{
+			cerr << "Missing value for " << arg << endl;
+			return 1;
+		}
+		if( arg == "-shape" )
+			shape = argv[++i];
+		else if( arg == "-size" )
+			size = atol(argv[++i]);
+		else if( arg == "-depth" )
+			depth = atoi(argv[++i]);
+		else if( arg == "-seed" )
+			seed = atoi(argv[++i]);
+		else
+		{
+			cerr << "Unrecognized flag " << arg << endl;
+			return 1;
+		}
+	}
+	if( shape != "expr" && shape != "decls" && shape != "ifs" && shape != "concat"
+		&& shape != "comments" && shape != "mixed" )
+	{
+		cerr << "Unknown shape " << shape << endl;
+		return 1;
+	}
+	if( depth < 1 )
+		depth = 1;
+	srand(seed);
+
+	Gen gen(depth);
+	ostringstream decls;
+	decls << "   n0, n1, n2, n3, n4, n5, n6, n7 : integer := 1;\n"
+		<< "   s, t : string := \"start\";\n"
+		<< "   flag : boolean := true;\n"
+		<< "   limit : constant integer := 97;\n";
+
+	for( long i = 0; i < size; )
+	{
+		string kind = shape;
+		if( shape == "mixed" )
+		{
+			static const char* kinds[] = { "expr", "ifs", "concat", "comments", "expr", "concat" };
+			kind = kinds[rand() % 6];
+		}
+		long before = gen.statements;
+
+		if( kind == "expr" )
+			gen.Assign(1);
+		else if( kind == "decls" )
+		{
+			//one declaration per statement; each is used once so it is not dead
+			decls << "   d" << i << " : integer := " << rand() % 1000 << ";\n";
+			gen.body << "   " << gen.Int(i) << " := d" << i << " mod limit;\n";
+			gen.statements++;
+		}
+		else if( kind == "ifs" )
+			gen.If(1, depth > 4 ? 4 : depth);
+		else if( kind == "concat" )
+			gen.Concat(1, i);
+		else
+		{
+			gen.Comment(1);
+			gen.Assign(1);
+		}
+		if( i % 100 == 99 )
+			gen.Print(1);
+
+		i += gen.statements - before;
+	}
+
+	cout << "-- gensadal shape=" << shape << " statements=" << gen.statements + 1 << "\n"
+		<< "procedure bench is\n"
+		<< decls.str()
+		<< "begin\n"
+		<< gen.body.str()
+		<< "   putline(s);\n"
+		<< "end bench;\n";
+	return 0;
+}
@@ -0,0 +1,101 @@
+/*
+ * interpbench.cpp
+ * Speed of the PA3 interpreter
+ *
+ * CS280 - Spring 2025
+ *
+ * Interprets a workload and reports statements per second, using the
+ * statement count gensadal wrote into the workload. "direct" times the
+ * interpreter that evaluates while it parses (Prog); "compile" times
+ * Compile(), Optimize() and Execute() one by one. Program output goes
+ * through an OutSink to /dev/null, so formatting is still paid for.
+ *
+ *   g++ -std=c++11 -O2 -pthread -I.. interpbench.cpp ../S_Y_Parsar.cpp \
+ *       ../compile.cpp ../exec.cpp ../optimize.cpp ../lex.cpp ../val.cpp \
+ *       ../outsink.cpp ../insource.cpp ../instrument.cpp ../profile.cpp \
+ *       -o interpbench
+ *   ./interpbench prog.ada [-mode direct|compile|both] [-repeat n]
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "parserInterp.h"
+#include "ast.h"
+#include "outsink.h"
+#include "bench.h"
+
+using namespace std;
+
+int main(int argc, char *argv[])
+{
+	Workload w;
+	if( argc < 2 || !LoadWorkload(argv[1], w) )
+	{
+		cerr << "usage: interpbench prog.ada [-mode direct|compile|both] [-repeat n]" << endl;
+		return 1;
+	}
+	string mode = Mode(argc, argv, "both");
+	int repeats = Repeats(argc, argv);
+
+	int fd = open("/dev/null", O_WRONLY);
+	OutSink out(fd);
+	InSource in("", 0);
+	Session session(out, in);
+	BindSession(&session);
+
+	if( mode == "direct" || mode == "both" )
+	{
+		double best = 1e30;
+		for( int r = 0; r < repeats; r++ )
+		{
+			ResetInterp();
+			istringstream src(w.text);
+			int line = 1;
+			BenchClock::time_point start = BenchClock::now();
+			bool ok = Prog(src, line);
+			out.flush();
+			best = min(best, Seconds(start));
+			if( !ok )
+			{
+				cerr << "Unsuccessful Interpretation, " << ErrCount() << " errors" << endl;
+				return 1;
+			}
+		}
+		Report("interp.direct", w.statements, "statements", best);
+	}
+	if( mode == "compile" || mode == "both" )
+	{
+		double bestCompile = 1e30, bestOptimize = 1e30, bestExecute = 1e30;
+		for( int r = 0; r < repeats; r++ )
+		{
+			ResetInterp();
+			CompiledProg prog;
+			LexBuffer buf(w.text);
+			int line = 1;
+			BenchClock::time_point start = BenchClock::now();
+			bool ok = Compile(buf, line, prog);
+			bestCompile = min(bestCompile, Seconds(start));
+
+			start = BenchClock::now();
+			if( ok )
+				Optimize(prog);
+			bestOptimize = min(bestOptimize, Seconds(start));
+
+			start = BenchClock::now();
+			ok = ok && Execute(prog);
+			out.flush();
+			bestExecute = min(bestExecute, Seconds(start));
+			if( !ok )
+			{
+				cerr << "Unsuccessful Interpretation, " << ErrCount() << " errors" << endl;
+				return 1;
+			}
+		}
+		Report("interp.compile", w.statements, "statements", bestCompile);
+		Report("interp.optimize", w.statements, "statements", bestOptimize);
+		Report("interp.execute", w.statements, "statements", bestExecute);
+	}
+	BindSession(NULL);
+	return 0;
+}
@@ -0,0 +1,104 @@
+/*
+ * kwbench.cpp
+ * Microbenchmark for keyword classification in id_or_kw()
+ *
+ * CS280 - Spring 2025
+ *
+ * Times the table-free id_or_kw() in lex.cpp against the former version,
+ * which built a map<string,Token> on every call, and checks that both
+ * classify every keyword (in any letter case) the same way.
+ *
+ *   g++ -std=c++11 -O2 -I.. kwbench.cpp ../lex.cpp -o kwbench
+ *   ./kwbench [identifiers]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <vector>
+
+#include "lex.h"
+
+using namespace std;
+
+//id_or_kw() as it was before the keyword switch
+static LexItem MapIdOrKw(const string& lexeme, int linenum)
+{
+	string strlexeme = lexeme;
+	map<string,Token> kwmap = {
+		{ "put", PUT}, { "putline", PUTLN}, { "get", GET},
+		{ "if", IF }, { "elsif", ELSIF },
+		{ "else", ELSE },
+		{ "string", STRING },
+		{ "integer", INT },
+		{ "float", FLOAT },
+		{ "character", CHAR },
+		{ "boolean", BOOL },
+		{ "procedure", PROCEDURE }, { "begin", BEGIN },
+		{ "true", TRUE }, { "then", THEN }, { "constant", CONST },
+		{ "false", FALSE }, { "is", IS }, { "end", END },
+		{ "mod", MOD }, { "and", AND }, { "or", OR }, { "not", NOT },
+	};
+	for(size_t i = 0; i < lexeme.length(); i++)
+		strlexeme[i] = tolower(strlexeme[i]);
+	
+	Token tt = IDENT;
+	auto kIt = kwmap.find(strlexeme);
+	if( kIt != kwmap.end() )
+		tt = kIt->second;
+	if(tt == TRUE || tt == FALSE)
+		tt = BCONST;
+	return LexItem(tt, lexeme, linenum);
+}
+
+static const char* words[] = {
+	"put", "putline", "get", "if", "elsif", "else", "string", "integer",
+	"float", "character", "boolean", "procedure", "begin", "true", "then",
+	"constant", "false", "is", "end", "mod", "and", "or", "not",
+	"x", "y1", "count", "total_sum", "iff", "endif", "str", "flag",
+	"prod", "character1", "beginning", "n", "i_2", "PutLine", "ELSIF",
+};
+
+template <class F>
+static double Time(F classify, const vector<string>& ids, long& checksum)
+{
+	auto start = chrono::steady_clock::now();
+	for(size_t i = 0; i < ids.size(); i++)
+		checksum += classify(ids[i], 1).GetToken();
+	return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[])
+{
+	size_t n = argc > 1 ? atol(argv[1]) : 2000000;
+	size_t nwords = sizeof(words) / sizeof(words[0]);
+	
+	for(size_t i = 0; i < nwords; i++)
+	{
+		string w = words[i], upper = w;
+		for(size_t j = 0; j < upper.length(); j++)
+			upper[j] = toupper(upper[j]);
+		if( id_or_kw(w, 1).GetToken() != MapIdOrKw(w, 1).GetToken() ||
+			id_or_kw(upper, 1).GetToken() != MapIdOrKw(upper, 1).GetToken() )
+		{
+			cerr << "MISMATCH on " << w << endl;
+			return 1;
+		}
+	}
+	
+	vector<string> ids;
+	ids.reserve(n);
+	srand(280);
+	for(size_t i = 0; i < n; i++)
+		ids.push_back(words[rand() % nwords]);
+	
+	long sumMap = 0, sumKw = 0;
+	double tMap = Time(MapIdOrKw, ids, sumMap);
+	double tKw = Time(id_or_kw, ids, sumKw);
+	
+	cout << n << " identifiers" << endl;
+	cout << "map per call:   " << tMap << " s" << endl;
+	cout << "keyword switch: " << tKw << " s" << endl;
+	cout << "speedup:        " << tMap / tKw << "x" << endl;
+	return sumMap == sumKw ? 0 : 1;
+}
@@ -0,0 +1,110 @@
+/*
+ * lexbench.cpp
+ * Throughput of getNextToken() in the PA3 lexer
+ *
+ * CS280 - Spring 2025
+ *
+ * Lexes a workload to DONE, either from memory through a LexBuffer or
+ * through an istringstream, and reports tokens per second. Chunked mode
+ * tokenizes the buffer on up to -jobs threads (default one per core);
+ * sources under a quarter megabyte per thread are lexed on one.
+ *
+ *   g++ -std=c++11 -O2 -pthread -I.. lexbench.cpp ../lex.cpp -o lexbench
+ *   ./lexbench prog.ada [-mode buffer|stream|chunked|both] [-jobs n] [-repeat n]
+ */
+
+#include <thread>
+
+#include "lex.h"
+#include "bench.h"
+
+using namespace std;
+
+//Lex the whole source once; the token count, or -1 on a lexical error
+template <class Source>
+static long LexAll(Source& in)
+{
+	int line = 1;
+	long tokens = 0;
+	for( ;; )
+	{
+		LexItem tok = getNextToken(in, line);
+		if( tok == DONE )
+			return tokens;
+		if( tok == ERR )
+		{
+			cerr << "Lexical error at line " << line << ": " << tok.GetLexeme() << endl;
+			return -1;
+		}
+		tokens++;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	Workload w;
+	if( argc < 2 || !LoadWorkload(argv[1], w) )
+	{
+		cerr << "usage: lexbench prog.ada [-mode buffer|stream|chunked|both] [-jobs n] [-repeat n]" << endl;
+		return 1;
+	}
+	string mode = Mode(argc, argv, "both");
+	int repeats = Repeats(argc, argv);
+
+	if( mode == "buffer" || mode == "both" )
+	{
+		double best = 1e30;
+		long tokens = 0;
+		for( int r = 0; r < repeats; r++ )
+		{
+			LexBuffer buf(w.text);
+			BenchClock::time_point start = BenchClock::now();
+			tokens = LexAll(buf);
+			best = min(best, Seconds(start));
+			if( tokens < 0 )
+				return 1;
+		}
+		Report("lex.buffer", tokens, "tokens", best);
+	}
+	if( mode == "stream" || mode == "both" )
+	{
+		double best = 1e30;
+		long tokens = 0;
+		for( int r = 0; r < repeats; r++ )
+		{
+			istringstream in(w.text);
+			BenchClock::time_point start = BenchClock::now();
+			tokens = LexAll(in);
+			best = min(best, Seconds(start));
+			if( tokens < 0 )
+				return 1;
+		}
+		Report("lex.stream", tokens, "tokens", best);
+	}
+	if( mode == "chunked" )
+	{
+		unsigned jobs = thread::hardware_concurrency();
+		for( int i = 1; i + 1 < argc; i++ )
+		{
+			if( string(argv[i]) == "-jobs" && atoi(argv[i + 1]) > 0 )
+				jobs = atoi(argv[i + 1]);
+		}
+		double best = 1e30;
+		long tokens = 0;
+		for( int r = 0; r < repeats; r++ )
+		{
+			LexBuffer buf(w.text);
+			TokenArray array;
+			int line = 1;
+			BenchClock::time_point start = BenchClock::now();
+			Tokenize(buf, line, array, jobs ? jobs : 1);
+			best = min(best, Seconds(start));
+			//the same count as LexAll(), which leaves out DONE
+			tokens = (long)array.Size() - 1;
+		}
+		ostringstream phase;
+		phase << "lex.chunked" << (jobs ? jobs : 1);
+		Report(phase.str(), tokens, "tokens", best);
+	}
+	return 0;
+}
@@ -0,0 +1,47 @@
+/*
+ * parsebench.cpp
+ * Speed of the PA2 recursive-descent parser
+ *
+ * CS280 - Spring 2025
+ *
+ * Runs Prog() from PA2 over a workload and reports statements per second,
+ * using the statement count gensadal wrote into the workload. The parser
+ * keeps its declarations in globals, so each process parses once; repeat
+ * by running the benchmark again. The parser's own output is discarded.
+ *
+ *   g++ -std=c++11 -O2 -I../../PA2 parsebench.cpp ../../PA2/PA2_S_Yannam.cpp \
+ *       ../../PA2/lex.cpp -o parsebench
+ *   ./parsebench prog.ada
+ */
+
+#include "parser.h"
+#include "bench.h"
+
+using namespace std;
+
+int main(int argc, char *argv[])
+{
+	Workload w;
+	if( argc < 2 || !LoadWorkload(argv[1], w) )
+	{
+		cerr << "usage: parsebench prog.ada" << endl;
+		return 1;
+	}
+
+	istringstream in(w.text);
+	ofstream discard("/dev/null");
+	streambuf* saved = cout.rdbuf(discard.rdbuf());
+	int line = 1;
+	BenchClock::time_point start = BenchClock::now();
+	bool ok = Prog(in, line);
+	double seconds = Seconds(start);
+	cout.rdbuf(saved);
+
+	if( !ok )
+	{
+		cerr << "Unsuccessful Parsing, " << ErrCount() << " errors" << endl;
+		return 1;
+	}
+	Report("parse.pa2", w.statements, "statements", seconds);
+	return 0;
+}
@@ -0,0 +1,38 @@
+#!/bin/sh
+# runbench.sh
+# Build the benchmarks, generate one workload per shape and time the
+# lexer, the PA2 parser and the PA3 interpreter on each, one phase per
+# process so peak_kb belongs to that phase alone.
+#
+#   ./runbench.sh [size] [depth]
+#
+# Binaries and workloads go to $BENCH_DIR (default ./out).
+
+set -e
+cd "$(dirname "$0")"
+SIZE=${1:-20000}
+DEPTH=${2:-8}
+OUT=${BENCH_DIR:-out}
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--std=c++11 -O2}
+mkdir -p "$OUT"
+
+$CXX $CXXFLAGS gensadal.cpp -o "$OUT/gensadal"
+$CXX $CXXFLAGS -pthread -I.. lexbench.cpp ../lex.cpp -o "$OUT/lexbench"
+$CXX $CXXFLAGS -I../../PA2 parsebench.cpp ../../PA2/PA2_S_Yannam.cpp ../../PA2/lex.cpp -o "$OUT/parsebench"
+$CXX $CXXFLAGS -pthread -I.. interpbench.cpp ../S_Y_Parsar.cpp ../compile.cpp ../exec.cpp \
+	../optimize.cpp ../lex.cpp ../val.cpp ../outsink.cpp ../insource.cpp ../instrument.cpp ../profile.cpp \
+	-o "$OUT/interpbench"
+
+for shape in expr decls ifs concat comments mixed
+do
+	prog="$OUT/$shape.ada"
+	"$OUT/gensadal" -shape $shape -size "$SIZE" -depth "$DEPTH" > "$prog"
+	echo "== $shape ($(wc -c < "$prog") bytes)"
+	"$OUT/lexbench" "$prog" -mode buffer
+	"$OUT/lexbench" "$prog" -mode stream
+	"$OUT/lexbench" "$prog" -mode chunked
+	"$OUT/parsebench" "$prog"
+	"$OUT/interpbench" "$prog" -mode direct
+	"$OUT/interpbench" "$prog" -mode compile
+done
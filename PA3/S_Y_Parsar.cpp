@@ -3,57 +3,95 @@
 #include <queue>
 #include <sstream>
 #include <map>
+#include <unordered_map>
 #include "parserInterp.h"
+#include "instrument.h"
+#include "profile.h"
 #include <limits> 
 
 using namespace std;
 
 //--------------------------------------------------
-// Global tables and containers
+// Interpreter state
 //--------------------------------------------------
-map<string, bool> defVar;                   // declared vars
-map<string, Token> SymTable;               // var → type
-map<string, Value> TempsResults;           // var → current value
-queue<string>*     Ids_List;               // helper for DeclStmt
+// Every declared variable gets a dense slot when it is declared; the
+// identifier is looked up once per use and the slot indexes the vectors
+// of the current Session.
+static thread_local Session* boundSession = NULL;
 
-static bool failureInDeclPart = false;
-static bool inAssignStmt = false;
-static string currentProcName;
+Session& CurSession() {
+    if (!boundSession) {
+        static thread_local Session ownSession;
+        boundSession = &ownSession;
+    }
+    return *boundSession;
+}
+
+void BindSession(Session* s) {
+    boundSession = s;
+}
+
+static inline Session& Cur() {
+    return boundSession ? *boundSession : CurSession();
+}
 
 //--------------------------------------------------
-// Pushback token framework (from PA2)
+// Token lookahead over the Session's TokenStream
 //--------------------------------------------------
 namespace Parser {
-    static bool pushed_back = false;
-    static LexItem pushed_token;
-
     static LexItem GetNextToken(istream& in, int& line) {
-        if (pushed_back) {
-            pushed_back = false;
-            return pushed_token;
-        }
-        return getNextToken(in, line);
+        return Cur().tokens.Get(in, line);
+    }
+
+    // The token k places after the next one, left in the stream
+    static LexItem PeekToken(istream& in, int line, unsigned k = 0) {
+        return Cur().tokens.Peek(in, line, k);
     }
 
-    static void PushBackToken(LexItem & t) {
-        if (pushed_back) abort();
-        pushed_back = true;
-        pushed_token = t;
+    static void PushBackToken(const LexItem & t) {
+        Cur().tokens.PushBack(t);
     }
 }
 
 //--------------------------------------------------
 // Error counting / reporting
 //--------------------------------------------------
-static int error_count = 0;
-
 int ErrCount() {
-    return error_count;
+    return Cur().error_count;
 }
 
 void ParseError(int line, string msg) {
-    ++error_count;
-    cout << line << ": " << msg << endl;
+    ++Cur().error_count;
+    *Cur().out << line << ": " << msg << endl;
+}
+
+// Forget everything left over from a previous program, so one process
+// can interpret several files in a row
+void ResetInterp() {
+    Cur().Reset();
+    // nothing lexed by an earlier run is used again, so its lexemes go too
+    ClearInterned();
+}
+
+// Give a newly declared variable the next free slot. Variables are keyed
+// by their interned lexeme, so finding one hashes a pointer and never
+// compares the text.
+static int DeclareVar(const string* name, Token type) {
+    int slot = (int)Cur().SymTable.size();
+    INSTR_COUNT(lookups);
+    Cur().defVar[name] = slot;
+    Cur().SymTable.push_back(type);
+    Cur().TempsResults.push_back(Value());
+    Cur().Assigned.push_back(false);
+    Cur().SlotNames.push_back(*name);
+    return slot;
+}
+
+// Slot of a declared variable, or -1
+static int LookupVar(const string* name) {
+    INSTR_COUNT(lookups);
+    auto it = Cur().defVar.find(name);
+    return it == Cur().defVar.end() ? -1 : it->second;
 }
 
 // Just checks declaration (no init check)
@@ -86,13 +124,14 @@ void DumpTables() {
             default:     return "UNKNOWN";
         }
     };
-    cout << "\nSymbol Table:\n";
-    for (auto &p : SymTable)
-        cout << "  " << p.first << " : " << tokenToString(p.second) << "\n";
-
-    cout << "\nValue Table:\n";
-    for (auto &p : TempsResults)
-        cout << "  " << p.first << " = " << p.second << "\n";
+    *Cur().out << "\nSymbol Table:\n";
+    for (size_t i = 0; i < Cur().SymTable.size(); i++)
+        *Cur().out << "  " << Cur().SlotNames[i] << " : " << tokenToString(Cur().SymTable[i]) << "\n";
+
+    *Cur().out << "\nValue Table:\n";
+    for (size_t i = 0; i < Cur().TempsResults.size(); i++)
+        if (Cur().Assigned[i])
+            *Cur().out << "  " << Cur().SlotNames[i] << " = " << Cur().TempsResults[i] << "\n";
 }
 
 //--------------------------------------------------
@@ -110,7 +149,7 @@ bool PrintStmts(istream& in, int& line);
 bool GetStmt(istream& in, int& line);
 bool IfStmt(istream& in, int& line);
 bool AssignStmt(istream& in, int& line);
-bool Var(istream& in, int& line, LexItem & idtok);
+bool Var(istream& in, int& line, int & slot);
 bool Expr(istream& in, int& line, Value & retVal);
 bool Relation(istream& in, int& line, Value & retVal);
 bool SimpleExpr(istream& in, int& line, Value & retVal);
@@ -141,8 +180,8 @@ bool Prog(istream& in, int& line)
         ParseError(line, "Missing Procedure Name.");
         return false;
     }
-    currentProcName = tok.GetLexeme();
-    defVar[currentProcName] = true;
+    Cur().currentProcName = tok.GetLexeme();
+    DeclareVar(tok.GetSymbol(), ERR);
 
     // 3) IS
     tok = Parser::GetNextToken(in, line);
@@ -154,7 +193,7 @@ bool Prog(istream& in, int& line)
     // 4) ProcBody
     bool bodyOk = ProcBody(in, line);
     if (!bodyOk) {
-        if (failureInDeclPart) {
+        if (Cur().failureInDeclPart) {
             ParseError(line + 1, "Incorrect compilation file.");
         } else {
             ParseError(line, "Incorrect Procedure Definition.");
@@ -170,8 +209,7 @@ bool Prog(istream& in, int& line)
     }
 
     // ** Success: just print DONE **
-    cout << endl;
-    cout << "(DONE)" << endl;
+    *Cur().out << "\n(DONE)\n";
     return true;
 }
 
@@ -182,7 +220,7 @@ bool ProcBody(istream& in, int& line)
 {
     // 1) parse declarations
     if (!DeclPart(in, line)) {
-        failureInDeclPart = true;
+        Cur().failureInDeclPart = true;
         return false;
     }
 
@@ -213,7 +251,7 @@ bool ProcBody(istream& in, int& line)
 		return false;
 	}
 	// **mismatch check**:
-	if (tok.GetLexeme() != currentProcName) {
+	if (tok.GetLexeme() != Cur().currentProcName) {
 		ParseError(line, "Procedure name mismatch in closing end identifier.");
 		return false;
 	}
@@ -226,7 +264,7 @@ bool ProcBody(istream& in, int& line)
 	}
 
 	// reset the flag (optional cleanup)
-	failureInDeclPart = false;
+	Cur().failureInDeclPart = false;
 	return true;
 }
 
@@ -237,16 +275,14 @@ bool StmtList(istream& in, int& line) {
         ParseError(line, "Syntactic error in statement list.");
         return false;
     }
-    LexItem tok = Parser::GetNextToken(in, line);
-    while (tok != END && tok != ELSIF && tok != ELSE && tok.GetToken() != DONE) {
-        Parser::PushBackToken(tok);
+    Token next = Parser::PeekToken(in, line).GetToken();
+    while (next != END && next != ELSIF && next != ELSE && next != DONE) {
         if (!Stmt(in, line)) {
             ParseError(line, "Syntactic error in statement list.");
             return false;
         }
-        tok = Parser::GetNextToken(in, line);
+        next = Parser::PeekToken(in, line).GetToken();
     }
-    Parser::PushBackToken(tok);
     return true;
 }
 
@@ -257,27 +293,23 @@ bool DeclPart(istream& in, int& line) {
         return false;
     }
     // if next token is not BEGIN, must be another DeclStmt
-    LexItem tok = Parser::GetNextToken(in, line);
-    if (tok.GetToken() == BEGIN) {
-        Parser::PushBackToken(tok);
+    if (Parser::PeekToken(in, line) == BEGIN)
         return true;
-    }
-    Parser::PushBackToken(tok);
     return DeclPart(in, line);
 }
 
 // DeclStmt ::= IDENT {, IDENT } : Type [ := Expr ] ;
 bool DeclStmt(istream& in, int& line) {
     // collect identifiers
-    Ids_List = new queue<string>();
+    Cur().Ids_List = queue<int>();
     if (!IdentList(in, line)) {
         ParseError(line, "Incorrect identifiers list in Declaration Statement.");
         return false;
     }
-    vector<string> names;
-    while (!Ids_List->empty()) {
-        names.push_back(Ids_List->front());
-        Ids_List->pop();
+    vector<int> slots;
+    while (!Cur().Ids_List.empty()) {
+        slots.push_back(Cur().Ids_List.front());
+        Cur().Ids_List.pop();
     }
 
     // colon
@@ -303,9 +335,8 @@ bool DeclStmt(istream& in, int& line) {
     }
     Token typeTok = t.GetToken();
     // record declarations
-    for (auto &v : names) {
-        SymTable[v] = typeTok;
-        defVar[v]    = true;
+    for (int v : slots) {
+        Cur().SymTable[v] = typeTok;
     }
 
     // optional range
@@ -331,8 +362,9 @@ bool DeclStmt(istream& in, int& line) {
             ParseError(line, "Incorrect initialization expression.");
             return false;
         }
-        for (auto &v : names) {
-            TempsResults[v] = initVal;
+        for (int v : slots) {
+            Cur().TempsResults[v] = initVal;
+            Cur().Assigned[v] = true;
         }
         t = Parser::GetNextToken(in, line);
     } else {
@@ -357,13 +389,12 @@ bool IdentList(istream& in, int& line) {
         // no identifiers is okay
         return true;
     }
-    string name = tok.GetLexeme();
-    if (defVar[name]) {
+    const string* name = tok.GetSymbol();
+    if (LookupVar(name) >= 0) {
         ParseError(line, "Variable Redefinition");
         return false;
     }
-    defVar[name] = true;
-    Ids_List->push(name);
+    Cur().Ids_List.push(DeclareVar(name, ERR));
 
     tok = Parser::GetNextToken(in, line);
     if (tok.GetToken() == COMMA) {
@@ -375,11 +406,13 @@ bool IdentList(istream& in, int& line) {
 
 // Stmt ::= AssignStmt | PrintStmts | GetStmt | IfStmt
 bool Stmt(istream& in, int& line) {
-    LexItem t = Parser::GetNextToken(in, line);
-    Parser::PushBackToken(t);
+    // decide on the statement without taking its first token
+    LexItem t = Parser::PeekToken(in, line);
 
     switch (t.GetToken()) {
         case IDENT: {
+            INSTR_COUNT(stmts[SC_ASSIGN]);
+            ProfileScope scope(PK_ASSIGN, t.GetLinenum());
             bool ok = AssignStmt(in, line);
             if (!ok) {
                 ParseError(line, "Invalid assignment statement.");
@@ -389,6 +422,8 @@ bool Stmt(istream& in, int& line) {
         }
 
         case IF: {
+            INSTR_COUNT(stmts[SC_IF]);
+            ProfileScope scope(PK_IF, t.GetLinenum());
             bool ok = IfStmt(in, line);
             if (!ok) {
                 ParseError(line, "Invalid If statement.");
@@ -398,6 +433,8 @@ bool Stmt(istream& in, int& line) {
         }
 
         case PUT: case PUTLN: {
+            INSTR_COUNT(stmts[SC_PRINT]);
+            ProfileScope scope(PK_PRINT, t.GetLinenum());
             bool ok = PrintStmts(in, line);
             if (!ok) {
                 ParseError(line, "Invalid put statement.");
@@ -407,6 +444,8 @@ bool Stmt(istream& in, int& line) {
         }
 
         case GET: {
+            INSTR_COUNT(stmts[SC_GET]);
+            ProfileScope scope(PK_GET, t.GetLinenum());
             bool ok = GetStmt(in, line);
             if (!ok) {
                 ParseError(line, "Invalid get statement.");
@@ -465,13 +504,39 @@ bool PrintStmts(istream& in, int& line) {
         return false;
     }
 
-    // *** Actual output ***
-    std::cout << val;
-    if (isLine) std::cout << std::endl;
+    // *** Actual output *** (no flush; the driver and GET flush)
+    PhaseTimer timer(PH_IO);
+    val.Write(*Cur().out);
+    if (isLine) Cur().out->put('\n');
 
     return true;
 }
 
+// Step over the statements of an arm that is not taken, stopping in front
+// of the END that closes the IF, or with stopAtElse also the next ELSIF or
+// ELSE. Nested IF ... END IF statements are skipped whole.
+static void SkipStmtList(istream& in, int& line, bool stopAtElse) {
+    int depth = 0;
+    LexItem t = Parser::GetNextToken(in, line);
+    while (t.GetToken() != DONE) {
+        if (t.GetToken() == IF) {
+            depth++;
+        }
+        else if (t.GetToken() == END) {
+            if (depth == 0) break;
+            depth--;
+            // the IF of END IF does not open another level
+            t = Parser::GetNextToken(in, line);
+            if (t.GetToken() != IF) continue;
+        }
+        else if (depth == 0 && stopAtElse && (t == ELSIF || t == ELSE)) {
+            break;
+        }
+        t = Parser::GetNextToken(in, line);
+    }
+    Parser::PushBackToken(t);
+}
+
 // IfStmt ::= IF Expr THEN StmtList { ELSIF Expr THEN StmtList } [ ELSE StmtList ] END IF ;
 bool IfStmt(istream& in, int& line) {
     // 1) IF
@@ -498,32 +563,25 @@ bool IfStmt(istream& in, int& line) {
 
     if (takeThen) {
         // 4a) RUN the then‐block
-        if (!StmtList(in, line)) {
-            ParseError(line, "Missing Statement for If-Stmt Then-clause");
-            return false;
+        {
+            ProfileScope taken(PK_THEN, line);
+            if (!StmtList(in, line)) {
+                ParseError(line, "Missing Statement for If-Stmt Then-clause");
+                return false;
+            }
         }
         // 4b) SKIP everything up to END IF
-        do {
-            t = Parser::GetNextToken(in, line);
-        } while (t.GetToken() != END && t.GetToken() != DONE);
-        Parser::PushBackToken(t);
+        SkipStmtList(in, line, false);
     }
     else {
         bool branchTaken = false;
 
         // 5) skip the THEN‐block entirely
-        do {
-            t = Parser::GetNextToken(in, line);
-        } while (t.GetToken()!=ELSIF && t.GetToken()!=ELSE && t.GetToken()!=END && t.GetToken()!=DONE);
-        Parser::PushBackToken(t);
+        SkipStmtList(in, line, true);
 
         // 6) zero or more ELSIF clauses
-        while (true) {
-            t = Parser::GetNextToken(in, line);
-            if (t.GetToken() != ELSIF) {
-                Parser::PushBackToken(t);
-                break;
-            }
+        while (Parser::PeekToken(in, line) == ELSIF) {
+            Parser::GetNextToken(in, line);
             // read the condition
             Value elifVal;
             if (!Expr(in, line, elifVal) || !elifVal.IsBool()) {
@@ -537,6 +595,7 @@ bool IfStmt(istream& in, int& line) {
             }
             // execute only the first true branch
             if (!branchTaken && elifVal.GetBool()) {
+                ProfileScope taken(PK_ELSIF, line);
                 if (!StmtList(in, line)) {
                     ParseError(line, "Missing Statement for If-Stmt Else-If-clause");
                     return false;
@@ -544,10 +603,7 @@ bool IfStmt(istream& in, int& line) {
                 branchTaken = true;
             } else {
                 // skip this clause’s statements
-                do {
-                    t = Parser::GetNextToken(in, line);
-                } while (t.GetToken()!=ELSIF && t.GetToken()!=ELSE && t.GetToken()!=END && t.GetToken()!=DONE);
-                Parser::PushBackToken(t);
+                SkipStmtList(in, line, true);
             }
         }
 
@@ -555,16 +611,14 @@ bool IfStmt(istream& in, int& line) {
         t = Parser::GetNextToken(in, line);
         if (t.GetToken() == ELSE) {
             if (!branchTaken) {
+                ProfileScope taken(PK_ELSE, line);
                 if (!StmtList(in, line)) {
                     ParseError(line, "Missing Statement for If-Stmt Else-clause");
                     return false;
                 }
             } else {
                 // skip else‐block if we already took a branch
-                do {
-                    t = Parser::GetNextToken(in, line);
-                } while (t.GetToken()!=END && t.GetToken()!=DONE);
-                Parser::PushBackToken(t);
+                SkipStmtList(in, line, false);
             }
         } else {
             Parser::PushBackToken(t);
@@ -592,6 +646,52 @@ bool IfStmt(istream& in, int& line) {
 }
 
 
+// One input value of the given type for GET. Values are separated by
+// white space; a string is one word and a character is the next non-blank
+// character. Missing or malformed input is reported as a run-time error.
+bool ReadInput(int line, Token type, Value& val) {
+    Session& s = Cur();
+    InSource::Status got = InSource::BAD;
+    PhaseTimer timer(PH_IO);
+
+    // show any prompt before waiting for input
+    s.out->flush();
+    if (type == INT) {
+        int v;
+        if ((got = s.in->ReadInt(v)) == InSource::GOT) val = Value(v);
+    }
+    else if (type == FLOAT) {
+        double v;
+        if ((got = s.in->ReadReal(v)) == InSource::GOT) val = Value(v);
+    }
+    else if (type == STRING) {
+        string v;
+        if ((got = s.in->ReadWord(v)) == InSource::GOT) val = Value(std::move(v));
+    }
+    else if (type == CHAR) {
+        char v;
+        if ((got = s.in->ReadChar(v)) == InSource::GOT) val = Value(v);
+    }
+    else if (type == BOOL) {
+        bool v;
+        if ((got = s.in->ReadBool(v)) == InSource::GOT) val = Value(v);
+    }
+    else {
+        ParseError(line, "Illegal input type for variable in GET");
+        return false;
+    }
+
+    if (got == InSource::END) {
+        ParseError(line, "Run-Time Error-Missing Input Value");
+        return false;
+    }
+    if (got == InSource::BAD) {
+        ParseError(line, "Run-Time Error-Illegal Input Value");
+        return false;
+    }
+    return true;
+}
+
 // GetStmt ::= GET ( Var ) ;
 bool GetStmt(istream& in, int& line) {
     // 1) GET
@@ -607,8 +707,8 @@ bool GetStmt(istream& in, int& line) {
         return false;
     }
     // 3) Var
-    LexItem idtok;
-    if (!Var(in, line, idtok)) {
+    int slot;
+    if (!Var(in, line, slot)) {
         ParseError(line, "Missing a variable for an input statement");
         return false;
     }
@@ -626,55 +726,25 @@ bool GetStmt(istream& in, int& line) {
         return false;
     }
 
-    // === 6) ACTUAL INPUT: read from cin and store into TempsResults ===
-    {
-        const string varName = idtok.GetLexeme();
-        Token varType = SymTable[varName];
-        if (varType == INT) {
-            int v;
-            std::cin >> v;
-            TempsResults[varName] = Value(v);
-        }
-        else if (varType == FLOAT) {
-            double v;
-            std::cin >> v;
-            TempsResults[varName] = Value(v);
-        }
-        else if (varType == STRING) {
-            // read a single word (no spaces)
-            string s;
-            std::cin >> s;
-            TempsResults[varName] = Value(s);
-        }
-        else if (varType == CHAR) {
-            char c;
-            std::cin >> c;
-            TempsResults[varName] = Value(c);
-        }
-        else if (varType == BOOL) {
-            string tok;
-            std::cin >> tok;
-            bool b = (tok == "true" || tok == "TRUE");
-            TempsResults[varName] = Value(b);
-        }
-        else {
-            ParseError(line, "Illegal input type for variable in GET");
-            return false;
-        }
-    }
+    // === 6) ACTUAL INPUT: read from the Session's input and store it ===
+    Value v;
+    if (!ReadInput(line, Cur().SymTable[slot], v))
+        return false;
+    Cur().TempsResults[slot] = std::move(v);
+    Cur().Assigned[slot] = true;
 
     return true;
 }
 // AssignStmt ::= Var := Expr ;
 bool AssignStmt(istream& in, int& line)
 {
-    inAssignStmt = true;
+    Cur().inAssignStmt = true;
 
     // 1) capture the LHS variable (only decl‐check, no uninit here)
-    LexItem idtok;
-    if (!Var(in, line, idtok)) {
+    int slot;
+    if (!Var(in, line, slot)) {
         ParseError(line, "Missing Left-Hand Side Variable in Assignment statement");
-        inAssignStmt = false;
+        Cur().inAssignStmt = false;
         return false;
     }
 
@@ -682,7 +752,7 @@ bool AssignStmt(istream& in, int& line)
     LexItem t = Parser::GetNextToken(in, line);
     if (t.GetToken() != ASSOP) {
         ParseError(line, "Missing Assignment Operator");
-        inAssignStmt = false;
+        Cur().inAssignStmt = false;
         return false;
     }
 
@@ -691,19 +761,19 @@ bool AssignStmt(istream& in, int& line)
     bool ex = Expr(in, line, rhs);
     if (!ex) {
         // 3a) if the LHS was never initialized, report it now
-        if (TempsResults.find(idtok.GetLexeme()) == TempsResults.end()) {
+        if (!Cur().Assigned[slot]) {
             ParseError(line, "Invalid use of an unintialized variable.");
             // 3b) now emit the operand‐error
             ParseError(line, "Incorrect operand");
         }
         // 3c) lastly the generic missing‐expr
         ParseError(line, "Missing Expression in Assignment Statement");
-        inAssignStmt = false;
+        Cur().inAssignStmt = false;
         return false;
     }
 
     // 4) type‐check (must exactly match)
-    Token declType = SymTable[idtok.GetLexeme()];
+    Token declType = Cur().SymTable[slot];
     bool typeOK = (declType == INT   && rhs.IsInt())
                || (declType == FLOAT && rhs.IsReal())
                || (declType == STRING&& rhs.IsString())
@@ -711,32 +781,32 @@ bool AssignStmt(istream& in, int& line)
                || (declType == BOOL  && rhs.IsBool());
     if (!typeOK) {
         ParseError(line, "Illegal Expression type for the assigned variable");
-        inAssignStmt = false;
+        Cur().inAssignStmt = false;
         return false;
     }
 
     // 5) do the store
-    TempsResults[idtok.GetLexeme()] = rhs;
+    Cur().TempsResults[slot] = std::move(rhs);
+    Cur().Assigned[slot] = true;
 
     // 6) consume ;
     t = Parser::GetNextToken(in, line);
     if (t.GetToken() != SEMICOL) {
         ParseError(line, "Missing semicolon at end of statement");
-        inAssignStmt = false;
+        Cur().inAssignStmt = false;
         return false;
     }
 
-    inAssignStmt = false;
+    Cur().inAssignStmt = false;
     return true;
 }
 
 // Var ::= IDENT
-bool Var(istream& in, int& line, LexItem & idtok) {
+bool Var(istream& in, int& line, int & slot) {
     LexItem tok = Parser::GetNextToken(in, line);
     if (tok.GetToken() == IDENT) {
-        idtok = tok;
-        string name = tok.GetLexeme();
-        if (!defVar[name]) {
+        slot = LookupVar(tok.GetSymbol());
+        if (slot < 0) {
             ParseError(line, "Undeclared Variable");
             return false;
         }
@@ -744,7 +814,7 @@ bool Var(istream& in, int& line, LexItem & idtok) {
     }
     if (tok.GetToken() == ERR) {
         ParseError(line, "Unrecognized Input Pattern");
-        cout << "(" << tok.GetLexeme() << ")\n";
+        *Cur().out << "(" << tok.GetLexeme() << ")\n";
         return false;
     }
     return false;
@@ -806,10 +876,8 @@ bool Relation(istream& in, int& line, Value & retVal) {
 
 //SimpleExpr ::= STerm { ( + | - | & ) STerm }
 bool SimpleExpr(istream& in, int& line, Value & retVal) {
-    // 1) parse the first term
-    Value left;
-    if (!STerm(in, line, left)) return false;
-    retVal = left;
+    // 1) parse the first term straight into the running result
+    if (!STerm(in, line, retVal)) return false;
 
     // 2) loop over any +, - or concatenation
     LexItem tok = Parser::GetNextToken(in, line);
@@ -823,24 +891,24 @@ bool SimpleExpr(istream& in, int& line, Value & retVal) {
 
         // 3) if it’s + or -, enforce same‐type numeric operands
         if (tok.GetToken() == PLUS || tok.GetToken() == MINUS) {
-            bool bothInt   = left.IsInt()  && right.IsInt();
-            bool bothReal  = left.IsReal() && right.IsReal();
+            bool bothInt   = retVal.IsInt()  && right.IsInt();
+            bool bothReal  = retVal.IsReal() && right.IsReal();
             if (!(bothInt || bothReal)) {
                 ParseError(line, "Illegal operand type for the operation.");
                 return false;
             }
             // perform the arithmetic
             retVal = (tok.GetToken() == PLUS)
-                     ? (left + right)
-                     : (left - right);
+                     ? (retVal + right)
+                     : (retVal - right);
         }
-        // 4) handle concatenation (&) for strings/chars
+        // 4) handle concatenation (&) for strings/chars, appending in place
+        //    so a long & chain is not copied once per operand
         else if (tok.GetToken() == CONCAT) {
-            retVal = left.Concat(right);
+            retVal.Append(right);
         }
 
-        // 5) shift for next iteration
-        left = retVal;
+        // 5) next operator
         tok = Parser::GetNextToken(in, line);
     }
 
@@ -877,10 +945,8 @@ bool STerm(istream& in, int& line, Value & retVal)
 
 // Term ::= Factor {( * | / | MOD) Factor}
 bool Term(istream& in, int& line, int sign, Value & retVal) {
-    // 1) parse first factor
-    Value left;
-    if (!Factor(in, line, sign, left)) return false;
-    retVal = left;
+    // 1) parse first factor straight into the running result
+    if (!Factor(in, line, sign, retVal)) return false;
 
     // 2) operator‐factor loop
     LexItem tok = Parser::GetNextToken(in, line);
@@ -895,8 +961,8 @@ bool Term(istream& in, int& line, int sign, Value & retVal) {
         // 3a) division or multiply
         if (tok == MULT || tok == DIV) {
             // must be same numeric type
-            bool bothInt  = left.IsInt()  && right.IsInt();
-            bool bothReal = left.IsReal() && right.IsReal();
+            bool bothInt  = retVal.IsInt()  && right.IsInt();
+            bool bothReal = retVal.IsReal() && right.IsReal();
             if (!(bothInt || bothReal)) {
                 ParseError(line, "Illegal operand type for the operation.");
                 return false;
@@ -916,11 +982,11 @@ bool Term(istream& in, int& line, int sign, Value & retVal) {
                 }
             }
             // perform the op
-            retVal = (tok == MULT) ? (left * right) : (left / right);
+            retVal = (tok == MULT) ? (retVal * right) : (retVal / right);
         }
         // 3b) modulus
         else {
-            if (!(left.IsInt() && right.IsInt())) {
+            if (!(retVal.IsInt() && right.IsInt())) {
                 ParseError(line, "Illegal operand type for the operation.");
                 return false;
             }
@@ -928,11 +994,10 @@ bool Term(istream& in, int& line, int sign, Value & retVal) {
                 ParseError(line, "Run-Time Error-Illegal division by Zero");
                 return false;
             }
-            retVal = left % right;
+            retVal = retVal % right;
         }
 
-        // 4) shift and continue
-        left = retVal;
+        // 4) next operator
         tok = Parser::GetNextToken(in, line);
     }
 
@@ -1031,22 +1096,22 @@ bool Name(istream& in, int& line, int sign, Value & retVal)
         ParseError(line, "Invalid reference to a variable.");
         return false;
     }
-    string nm = tok.GetLexeme();
+    int slot = LookupVar(tok.GetSymbol());
 
     // 2) must have been declared
-    if (!defVar[nm]) {
+    if (slot < 0) {
         ParseError(line, "Using Undefined Variable");
         return false;
     }
 
     // 3) must have been initialized before use
-    if (TempsResults.find(nm) == TempsResults.end()) {
+    if (!Cur().Assigned[slot]) {
         ParseError(line, "Invalid use of an unintialized variable.");
         return false;
     }
 
-    // 4) fetch its current value
-    Value baseVal = TempsResults[nm];
+    // 4) refer to its current value; it is copied only into the result
+    const Value& baseVal = Cur().TempsResults[slot];
 
     // 5) check for substring/index syntax
     tok = Parser::GetNextToken(in, line);
@@ -1068,7 +1133,7 @@ bool Name(istream& in, int& line, int sign, Value & retVal)
             ParseError(line, "Invalid range operation for non-string variable.");
             return false;
         }
-        string s = baseVal.GetString();
+        const string& s = baseVal.GetString();
         int len = (int)s.size();
         int lo = loVal.GetInt(), hi = hiVal.GetInt();
 
@@ -0,0 +1,129 @@
+/*
+ * ast.h
+ * Compiled form of a SADAL procedure
+ *
+ * CS280 - Spring 2025
+ *
+ * Compile() parses a procedure once into flat node pools; Execute() then
+ * runs it without touching the lexer. The nodes mirror the grammar
+ * productions so the executor reports run-time errors with the same
+ * messages and line numbers as the direct interpreter in S_Y_Parsar.cpp.
+*/
+
+#ifndef AST_H_
+#define AST_H_
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include "lex.h"
+#include "val.h"
+
+//Expression node kinds
+enum ExprKind {
+	N_CONST,	// literal constant: consts[a]
+	N_VAR,		// Name without a range (slot)
+	N_SUBSTR,	// Name ( Range ): a = N_RANGE node
+	N_RANGE,	// SimpleExpr [.. SimpleExpr]: a = lower bound, b = upper bound or -1
+	N_PAREN,	// ( Expr ): a
+	N_NOT,		// NOT Primary: a
+	N_EXP,		// Primary ** Primary: a, b
+	N_SIGN,		// ( + | - ) Term: a
+	N_BINARY,	// a op b, for AND, OR, relational, +, -, &, *, /, MOD
+};
+
+//Statement node kinds
+enum StmtKind { S_ASSIGN, S_PRINT, S_GET, S_IF };
+
+// Node indices refer into CompiledProg::exprs / CompiledProg::stmts; -1 means none.
+// "line" is the line number the interpreter would report for a run-time
+// check made by this node; "line2" is used by nodes making a second check.
+// Literals live in CompiledProg::consts, so a node is a few ints.
+struct ExprNode {
+	ExprKind kind;
+	Token	op;
+	int	line;
+	int	line2;
+	int	a;
+	int	b;
+	int	slot;
+
+	ExprNode(ExprKind k, int ln) : kind(k), op(ERR), line(ln), line2(ln), a(-1), b(-1), slot(-1) {}
+};
+
+// One arm of an IF statement: its condition (-1 for ELSE) and the
+// statements it guards, stmts[first, end)
+struct IfArm {
+	int	cond;
+	int	line;
+	int	first;
+	int	end;
+};
+
+// Statements are laid out in source order, so every statement list is a
+// contiguous range and "next" jumps over the bodies of an IF at once.
+struct StmtNode {
+	StmtKind kind;
+	int	line;
+	int	slot;		// target variable of S_ASSIGN / S_GET
+	int	expr;		// S_ASSIGN right-hand side, S_PRINT operand
+	bool	newline;	// S_PRINT: PUTLINE rather than PUT
+	int	arm;		// S_IF: arms[arm, arm + narms), IF arm first, ELSE arm last
+	int	narms;
+	int	next;		// statement following this one at the same level
+
+	StmtNode(StmtKind k, int ln) : kind(k), line(ln), slot(-1), expr(-1), newline(false), arm(-1), narms(0), next(-1) {}
+};
+
+// IDENT {, IDENT } : [CONSTANT] Type [ ( Range ) ] [ := Expr ] ;
+struct DeclNode {
+	vector<int> slots;
+	Token	type;
+	bool	isConst;
+	int	range;		// optional N_RANGE node or -1
+	int	init;		// initializer expression or -1
+
+	DeclNode() : type(ERR), isConst(false), range(-1), init(-1) {}
+};
+
+// Variables are numbered in declaration order; slot 0 is the procedure name.
+// The procedure body is stmts[0, stmts.size()).
+class CompiledProg {
+public:
+	string	procName;
+	vector<string> varNames;
+	vector<Token> varTypes;
+	vector<DeclNode> decls;
+	vector<ExprNode> exprs;
+	vector<Value> consts;	// values of the N_CONST nodes
+	vector<StmtNode> stmts;
+	vector<IfArm> arms;
+
+	void Clear() {
+		procName.clear();
+		varNames.clear();
+		varTypes.clear();
+		decls.clear();
+		exprs.clear();
+		consts.clear();
+		stmts.clear();
+		arms.clear();
+	}
+};
+
+extern void ParseError(int line, string msg);
+
+// Parse a whole procedure into prog; reports syntax and declaration errors only
+extern bool Compile(LexBuffer& in, int& line, CompiledProg& prog);
+extern bool Compile(istream& in, int& line, CompiledProg& prog);
+extern bool Compile(const TokenArray& tokens, int& line, CompiledProg& prog);
+// Fold constant subexpressions and CONSTANT variables of a compiled procedure
+// and remove the IF branches they rule out
+extern void Optimize(CompiledProg& prog);
+// Run a compiled procedure; reports run-time errors as the interpreter does
+extern bool Execute(const CompiledProg& prog);
+
+#endif /* AST_H_ */
@@ -0,0 +1,861 @@
+/* Compiler for the Simple Ada-Like (SADAL) Language
+ * compile.cpp
+ *
+ * CS280 - Spring 2025
+ *
+ * Same recursive-descent grammar as S_Y_Parsar.cpp, but instead of
+ * evaluating as it goes each function appends nodes to a CompiledProg.
+ * Only syntax and declaration errors are reported here; every check that
+ * depends on a value is recorded with its line number and left to Execute().
+ * Tokens are read from a LexBuffer, or walked from a TokenArray lexed up
+ * front; the istream overload of Compile() reads the whole stream into
+ * memory first.
+ */
+
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+#include "ast.h"
+#include "parserInterp.h"
+#include "instrument.h"
+#include "tokstream.h"
+
+using namespace std;
+
+namespace Compiler {
+
+static thread_local CompiledProg* prog;
+static thread_local unordered_map<string, int> defVar;   // declared var → slot
+static thread_local string currentProcName;
+static thread_local bool failureInDeclPart = false;
+// consts index of each literal met so far, by kind and interned lexeme
+static thread_local unordered_map<const string*, int> literals[DONE + 1];
+
+static thread_local TokenStream<LexBuffer> tokens;
+
+static LexItem GetNextToken(LexBuffer& in, int& line) {
+    return tokens.Get(in, line);
+}
+
+// The token k places after the next one, left in the stream
+static LexItem PeekToken(LexBuffer& in, int line, unsigned k = 0) {
+    return tokens.Peek(in, line, k);
+}
+
+static void PushBackToken(const LexItem & t) {
+    tokens.PushBack(t);
+}
+
+static int NewExpr(ExprKind kind, int line) {
+    prog->exprs.push_back(ExprNode(kind, line));
+    return (int)prog->exprs.size() - 1;
+}
+
+// A literal node; literals spelled alike share one entry in consts
+static int NewLiteral(const LexItem& tok, int line) {
+    int node = NewExpr(N_CONST, line);
+    auto found = literals[tok.GetToken()].emplace(tok.GetSymbol(), (int)prog->consts.size());
+    prog->exprs[node].a = found.first->second;
+    if (!found.second)
+        return node;
+    const string& lexeme = tok.GetLexeme();
+    switch (tok.GetToken()) {
+        case ICONST: prog->consts.push_back(Value(stoi(lexeme))); break;
+        case FCONST: prog->consts.push_back(Value(stod(lexeme))); break;
+        case SCONST: prog->consts.push_back(Value(lexeme)); break;
+        case BCONST: prog->consts.push_back(Value(lexeme == "true")); break;
+        default:     prog->consts.push_back(Value(lexeme[0])); break;
+    }
+    return node;
+}
+
+static int NewStmt(StmtKind kind, int line) {
+    int s = (int)prog->stmts.size();
+    prog->stmts.push_back(StmtNode(kind, line));
+    prog->stmts[s].next = s + 1;
+    return s;
+}
+
+static int DeclareVar(const string& name, Token type) {
+    int slot = (int)prog->varNames.size();
+    INSTR_COUNT(lookups);
+    defVar[name] = slot;
+    prog->varNames.push_back(name);
+    prog->varTypes.push_back(type);
+    return slot;
+}
+
+static int LookupVar(const string& name) {
+    INSTR_COUNT(lookups);
+    auto it = defVar.find(name);
+    return it == defVar.end() ? -1 : it->second;
+}
+
+static bool ProcBody(LexBuffer& in, int& line);
+static bool DeclPart(LexBuffer& in, int& line);
+static bool DeclStmt(LexBuffer& in, int& line);
+static bool IdentList(LexBuffer& in, int& line, vector<int>& slots);
+static bool StmtList(LexBuffer& in, int& line);
+static bool Stmt(LexBuffer& in, int& line);
+static bool PrintStmts(LexBuffer& in, int& line);
+static bool GetStmt(LexBuffer& in, int& line);
+static bool IfStmt(LexBuffer& in, int& line);
+static bool AssignStmt(LexBuffer& in, int& line);
+static bool Var(LexBuffer& in, int& line, int & slot);
+static bool Expr(LexBuffer& in, int& line, int& node);
+static bool Relation(LexBuffer& in, int& line, int& node);
+static bool SimpleExpr(LexBuffer& in, int& line, int& node);
+static bool STerm(LexBuffer& in, int& line, int& node);
+static bool Term(LexBuffer& in, int& line, int& node);
+static bool Factor(LexBuffer& in, int& line, int& node);
+static bool Primary(LexBuffer& in, int& line, int& node);
+static bool Name(LexBuffer& in, int& line, int& node);
+static bool Range(LexBuffer& in, int& line, int& node);
+
+// Prog ::= PROCEDURE ProcName IS ProcBody
+static bool Prog(LexBuffer& in, int& line)
+{
+    LexItem tok = GetNextToken(in, line);
+    if (tok.GetToken() != PROCEDURE) {
+        ParseError(line, "Incorrect compilation file.");
+        return false;
+    }
+
+    tok = GetNextToken(in, line);
+    if (tok.GetToken() != IDENT) {
+        ParseError(line, "Missing Procedure Name.");
+        return false;
+    }
+    currentProcName = tok.GetLexeme();
+    prog->procName = currentProcName;
+    DeclareVar(currentProcName, ERR);
+
+    tok = GetNextToken(in, line);
+    if (tok.GetToken() != IS) {
+        ParseError(line, "Incorrect Procedure Header Format.");
+        return false;
+    }
+
+    if (!ProcBody(in, line)) {
+        if (failureInDeclPart) {
+            ParseError(line + 1, "Incorrect compilation file.");
+        } else {
+            ParseError(line, "Incorrect Procedure Definition.");
+        }
+        return false;
+    }
+
+    tok = GetNextToken(in, line);
+    if (tok.GetToken() != DONE) {
+        ParseError(line, "Incorrect compilation file.");
+        return false;
+    }
+    return true;
+}
+
+// ProcBody ::= DeclPart BEGIN StmtList END ProcName ;
+static bool ProcBody(LexBuffer& in, int& line)
+{
+    if (!DeclPart(in, line)) {
+        failureInDeclPart = true;
+        return false;
+    }
+
+    LexItem tok = GetNextToken(in, line);
+    if (tok.GetToken() != BEGIN) {
+        ParseError(line, "Incorrect procedure body.");
+        return false;
+    }
+
+    if (!StmtList(in, line)) {
+        ParseError(line, "Incorrect Proedure Body.");
+        return false;
+    }
+
+    tok = GetNextToken(in, line);
+    if (tok.GetToken() != END) {
+        ParseError(line, "Missing END of Procedure Keyword.");
+        return false;
+    }
+    tok = GetNextToken(in, line);
+    if (tok.GetToken() != IDENT) {
+        ParseError(line, "Missing END of procedure name.");
+        return false;
+    }
+    if (tok.GetLexeme() != currentProcName) {
+        ParseError(line, "Procedure name mismatch in closing end identifier.");
+        return false;
+    }
+    tok = GetNextToken(in, line);
+    if (tok.GetToken() != SEMICOL) {
+        ParseError(line, "Missing end of procedure semicolon.");
+        return false;
+    }
+
+    failureInDeclPart = false;
+    return true;
+}
+
+// StmtList ::= Stmt { Stmt }
+static bool StmtList(LexBuffer& in, int& line) {
+    if (!Stmt(in, line)) {
+        ParseError(line, "Syntactic error in statement list.");
+        return false;
+    }
+    Token next = PeekToken(in, line).GetToken();
+    while (next != END && next != ELSIF && next != ELSE && next != DONE) {
+        if (!Stmt(in, line)) {
+            ParseError(line, "Syntactic error in statement list.");
+            return false;
+        }
+        next = PeekToken(in, line).GetToken();
+    }
+    return true;
+}
+
+// DeclPart ::= DeclStmt { DeclStmt }
+static bool DeclPart(LexBuffer& in, int& line) {
+    if (!DeclStmt(in, line)) {
+        ParseError(line, "Non-recognizable Declaration Part.");
+        return false;
+    }
+    if (PeekToken(in, line) == BEGIN)
+        return true;
+    return DeclPart(in, line);
+}
+
+// DeclStmt ::= IDENT {, IDENT } : [CONSTANT] Type [ ( Range ) ] [ := Expr ] ;
+static bool DeclStmt(LexBuffer& in, int& line) {
+    DeclNode decl;
+    if (!IdentList(in, line, decl.slots)) {
+        ParseError(line, "Incorrect identifiers list in Declaration Statement.");
+        return false;
+    }
+
+    LexItem t = GetNextToken(in, line);
+    if (t.GetToken() != COLON) {
+        PushBackToken(t);
+        ParseError(line, "Incorrect Declaration Statement Syntax.");
+        return false;
+    }
+
+    t = GetNextToken(in, line);
+    if (t.GetToken() == CONST) {
+        decl.isConst = true;
+        t = GetNextToken(in, line);
+    }
+
+    if (t.GetToken() != INT && t.GetToken() != FLOAT &&
+        t.GetToken() != STRING && t.GetToken() != BOOL &&
+        t.GetToken() != CHAR) {
+        ParseError(line, "Incorrect Declaration Type.");
+        return false;
+    }
+    decl.type = t.GetToken();
+    for (int v : decl.slots) {
+        prog->varTypes[v] = decl.type;
+    }
+
+    t = GetNextToken(in, line);
+    if (t.GetToken() == LPAREN) {
+        if (!Range(in, line, decl.range)) {
+            ParseError(line, "Incorrect definition of a range in declaration statement");
+            return false;
+        }
+        t = GetNextToken(in, line);
+        if (t.GetToken() != RPAREN) {
+            ParseError(line, "Incorrect syntax for a range in declaration statement");
+            return false;
+        }
+        t = GetNextToken(in, line);
+    }
+
+    if (t.GetToken() == ASSOP) {
+        if (!Expr(in, line, decl.init)) {
+            ParseError(line, "Incorrect initialization expression.");
+            return false;
+        }
+        t = GetNextToken(in, line);
+    }
+
+    if (t.GetToken() != SEMICOL) {
+        --line;
+        ParseError(line, "Missing semicolon at end of statement");
+        return false;
+    }
+    prog->decls.push_back(decl);
+    return true;
+}
+
+// IdentList ::= IDENT { , IDENT }
+static bool IdentList(LexBuffer& in, int& line, vector<int>& slots) {
+    LexItem tok = GetNextToken(in, line);
+    if (tok.GetToken() != IDENT) {
+        PushBackToken(tok);
+        return true;
+    }
+    const string& name = tok.GetLexeme();
+    if (LookupVar(name) >= 0) {
+        ParseError(line, "Variable Redefinition");
+        return false;
+    }
+    slots.push_back(DeclareVar(name, ERR));
+
+    tok = GetNextToken(in, line);
+    if (tok.GetToken() == COMMA) {
+        return IdentList(in, line, slots);
+    }
+    PushBackToken(tok);
+    return true;
+}
+
+// Stmt ::= AssignStmt | PrintStmts | GetStmt | IfStmt
+static bool Stmt(LexBuffer& in, int& line) {
+    // decide on the statement without taking its first token
+    switch (PeekToken(in, line).GetToken()) {
+        case IDENT:
+            if (!AssignStmt(in, line)) {
+                ParseError(line, "Invalid assignment statement.");
+                return false;
+            }
+            return true;
+
+        case IF:
+            if (!IfStmt(in, line)) {
+                ParseError(line, "Invalid If statement.");
+                return false;
+            }
+            return true;
+
+        case PUT: case PUTLN:
+            if (!PrintStmts(in, line)) {
+                ParseError(line, "Invalid put statement.");
+                return false;
+            }
+            return true;
+
+        case GET:
+            if (!GetStmt(in, line)) {
+                ParseError(line, "Invalid get statement.");
+                return false;
+            }
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+// PrintStmts ::= (PutLine | Put) ( Expr ) ;
+static bool PrintStmts(LexBuffer& in, int& line) {
+    LexItem t = GetNextToken(in, line);
+    bool isLine;
+    if (t == PUT) {
+        isLine = false;
+    }
+    else if (t == PUTLN) {
+        isLine = true;
+    }
+    else {
+        ParseError(line, "Missing Put or PutLine Keyword");
+        return false;
+    }
+
+    t = GetNextToken(in, line);
+    if (t != LPAREN) {
+        ParseError(line, "Missing Left Parenthesis");
+        return false;
+    }
+
+    int expr;
+    if (!Expr(in, line, expr)) {
+        ParseError(line, "Incorrect operand");
+        ParseError(line, "Missing expression for an output statement");
+        return false;
+    }
+
+    t = GetNextToken(in, line);
+    if (t != RPAREN) {
+        ParseError(line, "Missing Right Parenthesis");
+        return false;
+    }
+
+    t = GetNextToken(in, line);
+    if (t != SEMICOL) {
+        --line;
+        ParseError(line, "Missing semicolon at end of statement");
+        return false;
+    }
+
+    int s = NewStmt(S_PRINT, line);
+    prog->stmts[s].expr = expr;
+    prog->stmts[s].newline = isLine;
+    return true;
+}
+
+// IfStmt ::= IF Expr THEN StmtList { ELSIF Expr THEN StmtList } [ ELSE StmtList ] END IF ;
+static bool IfStmt(LexBuffer& in, int& line) {
+    LexItem t = GetNextToken(in, line);
+    if (t.GetToken() != IF) {
+        ParseError(line, "Missing IF Keyword");
+        return false;
+    }
+
+    // the IF goes before the statements of its arms
+    int s = NewStmt(S_IF, line);
+    vector<IfArm> arms;
+
+    IfArm arm;
+    if (!Expr(in, line, arm.cond)) {
+        ParseError(line, "Invalid expression type for an If condition");
+        return false;
+    }
+    arm.line = line;
+
+    t = GetNextToken(in, line);
+    if (t.GetToken() != THEN) {
+        ParseError(line, "If-Stmt Syntax Error");
+        return false;
+    }
+    arm.first = (int)prog->stmts.size();
+    if (!StmtList(in, line)) {
+        ParseError(line, "Missing Statement for If-Stmt Then-clause");
+        return false;
+    }
+    arm.end = (int)prog->stmts.size();
+    arms.push_back(arm);
+
+    t = GetNextToken(in, line);
+    while (t.GetToken() == ELSIF) {
+        if (!Expr(in, line, arm.cond)) {
+            ParseError(line, "Invalid expression type for an Elsif condition");
+            return false;
+        }
+        arm.line = line;
+        t = GetNextToken(in, line);
+        if (t.GetToken() != THEN) {
+            ParseError(line, "Elsif-Stmt Syntax Error");
+            return false;
+        }
+        arm.first = (int)prog->stmts.size();
+        if (!StmtList(in, line)) {
+            ParseError(line, "Missing Statement for If-Stmt Else-If-clause");
+            return false;
+        }
+        arm.end = (int)prog->stmts.size();
+        arms.push_back(arm);
+        t = GetNextToken(in, line);
+    }
+
+    if (t.GetToken() == ELSE) {
+        arm.cond = -1;
+        arm.line = line;
+        arm.first = (int)prog->stmts.size();
+        if (!StmtList(in, line)) {
+            ParseError(line, "Missing Statement for If-Stmt Else-clause");
+            return false;
+        }
+        arm.end = (int)prog->stmts.size();
+        arms.push_back(arm);
+        t = GetNextToken(in, line);
+    }
+
+    if (t.GetToken() != END) {
+        ParseError(line, "Missing closing END IF for If-statement.");
+        return false;
+    }
+    t = GetNextToken(in, line);
+    if (t.GetToken() != IF) {
+        ParseError(line, "Missing closing END IF for If-statement.");
+        return false;
+    }
+    t = GetNextToken(in, line);
+    if (t.GetToken() != SEMICOL) {
+        --line;
+        ParseError(line, "Missing semicolon at end of statement");
+        return false;
+    }
+
+    prog->stmts[s].arm = (int)prog->arms.size();
+    prog->stmts[s].narms = (int)arms.size();
+    prog->stmts[s].next = (int)prog->stmts.size();
+    prog->arms.insert(prog->arms.end(), arms.begin(), arms.end());
+    return true;
+}
+
+// GetStmt ::= GET ( Var ) ;
+static bool GetStmt(LexBuffer& in, int& line) {
+    LexItem t = GetNextToken(in, line);
+    if (t.GetToken() != GET) {
+        ParseError(line, "Missing Get Keyword");
+        return false;
+    }
+    t = GetNextToken(in, line);
+    if (t.GetToken() != LPAREN) {
+        ParseError(line, "Missing Left Parenthesis");
+        return false;
+    }
+    int slot;
+    if (!Var(in, line, slot)) {
+        ParseError(line, "Missing a variable for an input statement");
+        return false;
+    }
+    t = GetNextToken(in, line);
+    if (t.GetToken() != RPAREN) {
+        ParseError(line, "Missing Right Parenthesis");
+        return false;
+    }
+    t = GetNextToken(in, line);
+    if (t.GetToken() != SEMICOL) {
+        --line;
+        ParseError(line, "Missing semicolon at end of statement");
+        return false;
+    }
+
+    int s = NewStmt(S_GET, line);
+    prog->stmts[s].slot = slot;
+    return true;
+}
+
+// AssignStmt ::= Var := Expr ;
+static bool AssignStmt(LexBuffer& in, int& line)
+{
+    int slot;
+    if (!Var(in, line, slot)) {
+        ParseError(line, "Missing Left-Hand Side Variable in Assignment statement");
+        return false;
+    }
+
+    LexItem t = GetNextToken(in, line);
+    if (t.GetToken() != ASSOP) {
+        ParseError(line, "Missing Assignment Operator");
+        return false;
+    }
+
+    int rhs;
+    if (!Expr(in, line, rhs)) {
+        ParseError(line, "Missing Expression in Assignment Statement");
+        return false;
+    }
+    int checkLine = line;
+
+    t = GetNextToken(in, line);
+    if (t.GetToken() != SEMICOL) {
+        ParseError(line, "Missing semicolon at end of statement");
+        return false;
+    }
+
+    int s = NewStmt(S_ASSIGN, checkLine);
+    prog->stmts[s].slot = slot;
+    prog->stmts[s].expr = rhs;
+    return true;
+}
+
+// Var ::= IDENT
+static bool Var(LexBuffer& in, int& line, int & slot) {
+    LexItem tok = GetNextToken(in, line);
+    if (tok.GetToken() == IDENT) {
+        slot = LookupVar(tok.GetLexeme());
+        if (slot < 0) {
+            ParseError(line, "Undeclared Variable");
+            return false;
+        }
+        return true;
+    }
+    if (tok.GetToken() == ERR) {
+        ParseError(line, "Unrecognized Input Pattern");
+        *CurSession().out << "(" << tok.GetLexeme() << ")\n";
+        return false;
+    }
+    return false;
+}
+
+// Expr ::= Relation { ( AND | OR ) Relation }
+static bool Expr(LexBuffer& in, int& line, int& node) {
+    if (!Relation(in, line, node)) return false;
+    LexItem tok = GetNextToken(in, line);
+    while (tok.GetToken() == AND || tok.GetToken() == OR) {
+        int right;
+        if (!Relation(in, line, right)) {
+            ParseError(line, "Missing operand after operator");
+            return false;
+        }
+        int n = NewExpr(N_BINARY, line);
+        prog->exprs[n].op = tok.GetToken();
+        prog->exprs[n].a = node;
+        prog->exprs[n].b = right;
+        node = n;
+        tok = GetNextToken(in, line);
+    }
+    PushBackToken(tok);
+    return true;
+}
+
+// Relation ::= SimpleExpr [ ( = | /= | < | <= | > | >= ) SimpleExpr ]
+static bool Relation(LexBuffer& in, int& line, int& node) {
+    if (!SimpleExpr(in, line, node)) return false;
+
+    LexItem opTok = GetNextToken(in, line);
+    if (opTok.GetToken() == EQ || opTok.GetToken() == NEQ ||
+        opTok.GetToken() == LTHAN || opTok.GetToken() == GTHAN ||
+        opTok.GetToken() == LTE || opTok.GetToken() == GTE) {
+        int right;
+        if (!SimpleExpr(in, line, right)) {
+            ParseError(line, "Missing operand after operator");
+            return false;
+        }
+        int n = NewExpr(N_BINARY, line);
+        prog->exprs[n].op = opTok.GetToken();
+        prog->exprs[n].a = node;
+        prog->exprs[n].b = right;
+        node = n;
+    } else {
+        PushBackToken(opTok);
+    }
+    return true;
+}
+
+// SimpleExpr ::= STerm { ( + | - | & ) STerm }
+static bool SimpleExpr(LexBuffer& in, int& line, int& node) {
+    if (!STerm(in, line, node)) return false;
+
+    LexItem tok = GetNextToken(in, line);
+    while (tok.GetToken() == PLUS || tok.GetToken() == MINUS || tok.GetToken() == CONCAT) {
+        int right;
+        if (!STerm(in, line, right)) {
+            ParseError(line, "Missing operand after operator");
+            return false;
+        }
+        int n = NewExpr(N_BINARY, line);
+        prog->exprs[n].op = tok.GetToken();
+        prog->exprs[n].a = node;
+        prog->exprs[n].b = right;
+        node = n;
+        tok = GetNextToken(in, line);
+    }
+    PushBackToken(tok);
+    return true;
+}
+
+// STerm ::= [( - | + )] Term
+static bool STerm(LexBuffer& in, int& line, int& node)
+{
+    LexItem t = GetNextToken(in, line);
+    Token sign = ERR;
+    if (t.GetToken() == MINUS || t.GetToken() == PLUS) sign = t.GetToken();
+    else                                               PushBackToken(t);
+
+    if (!Term(in, line, node))
+        return false;
+
+    if (sign != ERR) {
+        int n = NewExpr(N_SIGN, line);
+        prog->exprs[n].op = sign;
+        prog->exprs[n].a = node;
+        node = n;
+    }
+    return true;
+}
+
+// Term ::= Factor {( * | / | MOD) Factor}
+static bool Term(LexBuffer& in, int& line, int& node) {
+    if (!Factor(in, line, node)) return false;
+
+    LexItem tok = GetNextToken(in, line);
+    while (tok == MULT || tok == DIV || tok == MOD) {
+        int right;
+        if (!Factor(in, line, right)) {
+            return false;
+        }
+        int n = NewExpr(N_BINARY, line);
+        prog->exprs[n].op = tok.GetToken();
+        prog->exprs[n].a = node;
+        prog->exprs[n].b = right;
+        node = n;
+        tok = GetNextToken(in, line);
+    }
+    PushBackToken(tok);
+    return true;
+}
+
+// Factor ::= Primary [ ** Primary ] | NOT Primary
+static bool Factor(LexBuffer& in, int& line, int& node) {
+    LexItem tok = GetNextToken(in, line);
+    if (tok.GetToken() == NOT) {
+        int operand;
+        if (!Primary(in, line, operand)) {
+            ParseError(line, "Incorrect operand for NOT operator");
+            return false;
+        }
+        node = NewExpr(N_NOT, line);
+        prog->exprs[node].a = operand;
+        return true;
+    }
+    PushBackToken(tok);
+
+    if (!Primary(in, line, node)) {
+        return false;
+    }
+
+    tok = GetNextToken(in, line);
+    if (tok.GetToken() == EXP) {
+        int exponent;
+        if (!Primary(in, line, exponent)) {
+            ParseError(line, "Missing raised power for exponent operator");
+            return false;
+        }
+        int n = NewExpr(N_EXP, line);
+        prog->exprs[n].a = node;
+        prog->exprs[n].b = exponent;
+        node = n;
+    } else {
+        PushBackToken(tok);
+    }
+    return true;
+}
+
+// Primary ::= Name | ICONST | FCONST | SCONST | BCONST | CCONST | ( Expr )
+static bool Primary(LexBuffer& in, int& line, int& node) {
+    LexItem tok = GetNextToken(in, line);
+    switch (tok.GetToken()) {
+        case IDENT:
+            PushBackToken(tok);
+            return Name(in, line, node);
+        case ICONST: case FCONST: case SCONST: case BCONST: case CCONST:
+            node = NewLiteral(tok, line);
+            return true;
+        case LPAREN: {
+            int inner;
+            if (!Expr(in, line, inner)) {
+                ParseError(line, "Invalid expression after left parenthesis");
+                return false;
+            }
+            if (GetNextToken(in, line).GetToken() != RPAREN) {
+                ParseError(line, "Missing right parenthesis after expression");
+                return false;
+            }
+            node = NewExpr(N_PAREN, line);
+            prog->exprs[node].a = inner;
+            return true;
+        }
+        default:
+            ParseError(line, "Invalid Expression");
+            return false;
+    }
+}
+
+// Name ::= IDENT [ ( Range ) ]
+static bool Name(LexBuffer& in, int& line, int& node)
+{
+    LexItem tok = GetNextToken(in, line);
+    if (tok.GetToken() != IDENT) {
+        ParseError(line, "Invalid reference to a variable.");
+        return false;
+    }
+    int slot = LookupVar(tok.GetLexeme());
+
+    if (slot < 0) {
+        ParseError(line, "Using Undefined Variable");
+        return false;
+    }
+    int useLine = line;
+
+    tok = GetNextToken(in, line);
+    if (tok.GetToken() == LPAREN) {
+        int range;
+        if (!Range(in, line, range)) {
+            return false;
+        }
+        if (GetNextToken(in, line).GetToken() != RPAREN) {
+            ParseError(line, "Invalid syntax for an index or range definition.");
+            return false;
+        }
+        node = NewExpr(N_SUBSTR, useLine);
+        prog->exprs[node].line2 = line;
+        prog->exprs[node].slot = slot;
+        prog->exprs[node].a = range;
+        return true;
+    }
+
+    PushBackToken(tok);
+    node = NewExpr(N_VAR, useLine);
+    prog->exprs[node].slot = slot;
+    return true;
+}
+
+// Range ::= SimpleExpr [.. SimpleExpr]
+static bool Range(LexBuffer& in, int& line, int& node)
+{
+    int lo, hi = -1;
+    if (!SimpleExpr(in, line, lo)) {
+        ParseError(line, "Invalid expression for a lower bound definition of a range.");
+        return false;
+    }
+    int loLine = line, hiLine = line;
+
+    LexItem tok = GetNextToken(in, line);
+    if (tok.GetToken() == DOT) {
+        tok = GetNextToken(in, line);
+        if (tok.GetToken() != DOT) {
+            ParseError(line, "Invalid definition of a range.");
+            return false;
+        }
+        if (!SimpleExpr(in, line, hi)) {
+            ParseError(line, "Invalid expression for an upper bound definition of a range.");
+            return false;
+        }
+        hiLine = line;
+    } else {
+        PushBackToken(tok);
+    }
+
+    node = NewExpr(N_RANGE, loLine);
+    prog->exprs[node].line2 = hiLine;
+    prog->exprs[node].a = lo;
+    prog->exprs[node].b = hi;
+    return true;
+}
+
+// Start compiling a procedure of up to this many tokens into program. A
+// node takes at least one token, so exprs is never copied as it grows.
+// Literals are keyed by lexemes, which only last for one procedure.
+static void Start(CompiledProg& program, size_t tokens)
+{
+    program.Clear();
+    program.exprs.reserve(tokens);
+    prog = &program;
+    defVar.clear();
+    for (auto& seen : literals)
+        seen.clear();
+    failureInDeclPart = false;
+}
+
+} // namespace Compiler
+
+bool Compile(LexBuffer& in, int& line, CompiledProg& prog)
+{
+    // sources run to nearly three bytes a token
+    Compiler::Start(prog, (in.End() - in.Pos()) / 3);
+    Compiler::tokens.Clear();
+    return Compiler::Prog(in, line);
+}
+
+bool Compile(const TokenArray& tokens, int& line, CompiledProg& prog)
+{
+    // the stream walks the array, so the buffer is never read
+    LexBuffer unused;
+    Compiler::Start(prog, tokens.Size());
+    Compiler::tokens.Attach(&tokens);
+    bool status = Compiler::Prog(unused, line);
+    Compiler::tokens.Clear();
+    return status;
+}
+
+bool Compile(istream& in, int& line, CompiledProg& prog)
+{
+    ostringstream text;
+    text << in.rdbuf();
+    string source = text.str();
+    LexBuffer buf(source);
+    return Compile(buf, line, prog);
+}
@@ -0,0 +1,455 @@
+/* Execution engine for compiled SADAL procedures
+ * exec.cpp
+ *
+ * CS280 - Spring 2025
+ *
+ * Walks the node pools built by Compile(). Each function reports the same
+ * run-time errors, in the same order, as the grammar function it stands in
+ * for, so a failing program prints the same error cascade in both modes.
+ */
+
+#include <iostream>
+#include <vector>
+#include "ast.h"
+#include "parserInterp.h"
+#include "instrument.h"
+#include "profile.h"
+
+using namespace std;
+
+namespace Executor {
+
+// program being run and the Session it runs in, per thread
+static thread_local const CompiledProg* prog;
+static thread_local Session* sess;
+
+static bool StmtList(int first, int end, int& line);
+static bool Eval(int node, int& line, Value & retVal);
+
+// Range ::= SimpleExpr [.. SimpleExpr]
+static bool Range(int node, int& line, Value & loVal, Value & hiVal)
+{
+    const ExprNode& n = prog->exprs[node];
+    if (!Eval(n.a, line, loVal)) {
+        ParseError(line, "Invalid expression for a lower bound definition of a range.");
+        return false;
+    }
+    if (!loVal.IsInt()) {
+        line = n.line;
+        ParseError(line, "Invalid lowerbound or upperbound value of a range.");
+        return false;
+    }
+    if (n.b < 0) {
+        hiVal = loVal;
+        return true;
+    }
+    if (!Eval(n.b, line, hiVal)) {
+        ParseError(line, "Invalid expression for an upper bound definition of a range.");
+        return false;
+    }
+    line = n.line2;
+    if (!hiVal.IsInt() || loVal.GetInt() > hiVal.GetInt()) {
+        ParseError(line, "Invalid lowerbound or upperbound value of a range.");
+        return false;
+    }
+    return true;
+}
+
+// Name ::= IDENT [ ( Range ) ]
+static bool Name(const ExprNode& n, int& line, Value & retVal)
+{
+    if (!sess->Assigned[n.slot]) {
+        line = n.line;
+        ParseError(line, "Invalid use of an unintialized variable.");
+        return false;
+    }
+    if (n.kind == N_VAR) {
+        retVal = sess->TempsResults[n.slot];
+        return true;
+    }
+
+    const Value& baseVal = sess->TempsResults[n.slot];
+    Value loVal, hiVal;
+    if (!Range(n.a, line, loVal, hiVal)) {
+        return false;
+    }
+    line = n.line2;
+    if (!baseVal.IsString()) {
+        ParseError(line, "Invalid range operation for non-string variable.");
+        return false;
+    }
+    const string& s = baseVal.GetString();
+    int len = (int)s.size();
+    int lo = loVal.GetInt(), hi = hiVal.GetInt();
+    if (lo < 0 || hi >= len) {
+        if (lo == hi) {
+            ParseError(line, "Out of range index value.");
+        } else {
+            ParseError(line, "Invalid lowerbound or upperbound value of a range.");
+        }
+        return false;
+    }
+    if (lo == hi) {
+        retVal = Value(s[lo]);
+    } else {
+        retVal = Value(s.substr(lo, hi - lo + 1));
+    }
+    return true;
+}
+
+// a op b for every binary level of the grammar, Expr down to Term.
+// The left operand is evaluated into retVal, so a left-nested chain such
+// as a & b & c accumulates in a single Value.
+static bool Binary(const ExprNode& n, int& line, Value & retVal)
+{
+    Value& left = retVal;
+    Value right;
+    if (!Eval(n.a, line, left)) return false;
+    if (!Eval(n.b, line, right)) {
+        if (n.op != MULT && n.op != DIV && n.op != MOD)
+            ParseError(line, "Missing operand after operator");
+        return false;
+    }
+    line = n.line;
+
+    switch (n.op) {
+        // the logical operators keep the value of the last relation
+        case AND: case OR:
+            retVal = std::move(right);
+            return true;
+
+        case EQ:    retVal = left == right; return true;
+        case NEQ:   retVal = left != right; return true;
+        case LTHAN: retVal = left <  right; return true;
+        case LTE:   retVal = left <= right; return true;
+        case GTHAN: retVal = left >  right; return true;
+        case GTE:   retVal = left >= right; return true;
+
+        case CONCAT:
+            retVal.Append(right);
+            return true;
+
+        case PLUS: case MINUS: case MULT: case DIV: {
+            bool bothInt  = left.IsInt()  && right.IsInt();
+            bool bothReal = left.IsReal() && right.IsReal();
+            if (!(bothInt || bothReal)) {
+                ParseError(line, "Illegal operand type for the operation.");
+                return false;
+            }
+            if (n.op == DIV && (bothInt ? right.GetInt() == 0 : right.GetReal() == 0.0)) {
+                ParseError(line, "Run-Time Error-Illegal division by Zero");
+                return false;
+            }
+            if (n.op == PLUS)       retVal = left + right;
+            else if (n.op == MINUS) retVal = left - right;
+            else if (n.op == MULT)  retVal = left * right;
+            else                    retVal = left / right;
+            return true;
+        }
+
+        case MOD:
+            if (!(left.IsInt() && right.IsInt())) {
+                ParseError(line, "Illegal operand type for the operation.");
+                return false;
+            }
+            if (right.GetInt() == 0) {
+                ParseError(line, "Run-Time Error-Illegal division by Zero");
+                return false;
+            }
+            retVal = left % right;
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+static bool Eval(int node, int& line, Value & retVal)
+{
+    const ExprNode& n = prog->exprs[node];
+    switch (n.kind) {
+        case N_CONST:
+            retVal = prog->consts[n.a];
+            return true;
+
+        case N_VAR: case N_SUBSTR:
+            return Name(n, line, retVal);
+
+        case N_PAREN:
+            if (!Eval(n.a, line, retVal)) {
+                ParseError(line, "Invalid expression after left parenthesis");
+                return false;
+            }
+            return true;
+
+        case N_NOT:
+            if (!Eval(n.a, line, retVal)) {
+                ParseError(line, "Incorrect operand for NOT operator");
+                return false;
+            }
+            retVal = !retVal;
+            return true;
+
+        case N_EXP: {
+            Value exponent;
+            if (!Eval(n.a, line, retVal)) return false;
+            if (!Eval(n.b, line, exponent)) {
+                ParseError(line, "Missing raised power for exponent operator");
+                return false;
+            }
+            line = n.line;
+            if (!retVal.IsReal() || !exponent.IsReal()) {
+                ParseError(line, "Illegal operand type for the operation.");
+                return false;
+            }
+            retVal = retVal.Exp(exponent);
+            return true;
+        }
+
+        // the sign is only type-checked, as in STerm
+        case N_SIGN:
+            if (!Eval(n.a, line, retVal)) return false;
+            line = n.line;
+            if (!(retVal.IsInt() || retVal.IsReal())) {
+                ParseError(line, "Illegal Operand Type for Sign Operator");
+                ParseError(line, "Incorrect operand");
+                return false;
+            }
+            return true;
+
+        case N_BINARY:
+            return Binary(n, line, retVal);
+
+        default:
+            return false;
+    }
+}
+
+// AssignStmt ::= Var := Expr ;
+static bool AssignStmt(const StmtNode& s, int& line)
+{
+    Value rhs;
+    if (!Eval(s.expr, line, rhs)) {
+        if (!sess->Assigned[s.slot]) {
+            ParseError(line, "Invalid use of an unintialized variable.");
+            ParseError(line, "Incorrect operand");
+        }
+        ParseError(line, "Missing Expression in Assignment Statement");
+        return false;
+    }
+
+    line = s.line;
+    Token declType = prog->varTypes[s.slot];
+    bool typeOK = (declType == INT   && rhs.IsInt())
+               || (declType == FLOAT && rhs.IsReal())
+               || (declType == STRING&& rhs.IsString())
+               || (declType == CHAR  && rhs.IsChar())
+               || (declType == BOOL  && rhs.IsBool());
+    if (!typeOK) {
+        ParseError(line, "Illegal Expression type for the assigned variable");
+        return false;
+    }
+    sess->TempsResults[s.slot] = std::move(rhs);
+    sess->Assigned[s.slot] = true;
+    return true;
+}
+
+// PrintStmts ::= (PutLine | Put) ( Expr ) ;
+static bool PrintStmts(const StmtNode& s, int& line)
+{
+    Value val;
+    if (!Eval(s.expr, line, val)) {
+        ParseError(line, "Incorrect operand");
+        ParseError(line, "Missing expression for an output statement");
+        return false;
+    }
+    PhaseTimer timer(PH_IO);
+    val.Write(*sess->out);
+    if (s.newline) sess->out->put('\n');
+    return true;
+}
+
+// GetStmt ::= GET ( Var ) ;
+static bool GetStmt(const StmtNode& s, int& line)
+{
+    line = s.line;
+    Value v;
+    if (!ReadInput(line, prog->varTypes[s.slot], v))
+        return false;
+    sess->TempsResults[s.slot] = std::move(v);
+    sess->Assigned[s.slot] = true;
+    return true;
+}
+
+// IfStmt ::= IF Expr THEN StmtList { ELSIF Expr THEN StmtList } [ ELSE StmtList ] END IF ;
+static bool IfStmt(const StmtNode& s, int& line)
+{
+    const IfArm* arms = &prog->arms[s.arm];
+    const IfArm& arm = arms[0];
+    Value cond;
+    if (!Eval(arm.cond, line, cond)) {
+        ParseError(line, "Invalid expression type for an If condition");
+        return false;
+    }
+    line = arm.line;
+    if (!cond.IsBool()) {
+        ParseError(line, "Invalid expression type for an If condition");
+        return false;
+    }
+    if (cond.GetBool()) {
+        ProfileScope taken(PK_THEN, arm.line);
+        if (!StmtList(arm.first, arm.end, line)) {
+            ParseError(line, "Missing Statement for If-Stmt Then-clause");
+            return false;
+        }
+        return true;
+    }
+
+    // every ELSIF condition is evaluated; only the first true arm runs
+    bool branchTaken = false;
+    int i = 1;
+    for (; i < s.narms && arms[i].cond >= 0; i++) {
+        const IfArm& elif = arms[i];
+        Value elifVal;
+        if (!Eval(elif.cond, line, elifVal)) {
+            ParseError(line, "Invalid expression type for an Elsif condition");
+            return false;
+        }
+        line = elif.line;
+        if (!elifVal.IsBool()) {
+            ParseError(line, "Invalid expression type for an Elsif condition");
+            return false;
+        }
+        if (!branchTaken && elifVal.GetBool()) {
+            ProfileScope taken(PK_ELSIF, elif.line);
+            if (!StmtList(elif.first, elif.end, line)) {
+                ParseError(line, "Missing Statement for If-Stmt Else-If-clause");
+                return false;
+            }
+            branchTaken = true;
+        }
+    }
+
+    if (i < s.narms && !branchTaken) {
+        ProfileScope taken(PK_ELSE, arms[i].line);
+        if (!StmtList(arms[i].first, arms[i].end, line)) {
+            ParseError(line, "Missing Statement for If-Stmt Else-clause");
+            return false;
+        }
+    }
+    return true;
+}
+
+// Stmt ::= AssignStmt | PrintStmts | GetStmt | IfStmt
+static bool Stmt(int stmt, int& line)
+{
+    static const ProfKind profKind[] = { PK_ASSIGN, PK_PRINT, PK_GET, PK_IF };
+    const StmtNode& s = prog->stmts[stmt];
+    ProfileScope scope(profKind[s.kind], s.line);
+    switch (s.kind) {
+        case S_ASSIGN:
+            INSTR_COUNT(stmts[SC_ASSIGN]);
+            if (!AssignStmt(s, line)) {
+                ParseError(line, "Invalid assignment statement.");
+                return false;
+            }
+            return true;
+
+        case S_IF:
+            INSTR_COUNT(stmts[SC_IF]);
+            if (!IfStmt(s, line)) {
+                ParseError(line, "Invalid If statement.");
+                return false;
+            }
+            return true;
+
+        case S_PRINT:
+            INSTR_COUNT(stmts[SC_PRINT]);
+            if (!PrintStmts(s, line)) {
+                ParseError(line, "Invalid put statement.");
+                return false;
+            }
+            return true;
+
+        case S_GET:
+            INSTR_COUNT(stmts[SC_GET]);
+            if (!GetStmt(s, line)) {
+                ParseError(line, "Invalid get statement.");
+                return false;
+            }
+            return true;
+    }
+    return false;
+}
+
+// StmtList ::= Stmt { Stmt }
+static bool StmtList(int first, int end, int& line)
+{
+    for (int stmt = first; stmt < end; stmt = prog->stmts[stmt].next) {
+        if (!Stmt(stmt, line)) {
+            ParseError(line, "Syntactic error in statement list.");
+            return false;
+        }
+    }
+    return true;
+}
+
+// DeclStmt ::= IDENT {, IDENT } : [CONSTANT] Type [ ( Range ) ] [ := Expr ] ;
+static bool DeclStmt(const DeclNode& d, int& line)
+{
+    if (d.range >= 0) {
+        Value retVal1, retVal2;
+        if (!Range(d.range, line, retVal1, retVal2)) {
+            ParseError(line, "Incorrect definition of a range in declaration statement");
+            return false;
+        }
+    }
+    if (d.init >= 0) {
+        Value initVal;
+        if (!Eval(d.init, line, initVal)) {
+            ParseError(line, "Incorrect initialization expression.");
+            return false;
+        }
+        for (int v : d.slots) {
+            sess->TempsResults[v] = initVal;
+            sess->Assigned[v] = true;
+        }
+    }
+    return true;
+}
+
+// ProcBody ::= DeclPart BEGIN StmtList END ProcName ;
+static bool ProcBody(int& line)
+{
+    for (const DeclNode& d : prog->decls) {
+        if (!DeclStmt(d, line)) {
+            ParseError(line, "Non-recognizable Declaration Part.");
+            ParseError(line + 1, "Incorrect compilation file.");
+            return false;
+        }
+    }
+    if (!StmtList(0, (int)prog->stmts.size(), line)) {
+        ParseError(line, "Incorrect Proedure Body.");
+        ParseError(line, "Incorrect Procedure Definition.");
+        return false;
+    }
+    return true;
+}
+
+} // namespace Executor
+
+bool Execute(const CompiledProg& prog)
+{
+    int line = 0;
+    Session& session = CurSession();
+    Executor::prog = &prog;
+    Executor::sess = &session;
+    session.TempsResults.assign(prog.varNames.size(), Value());
+    session.Assigned.assign(prog.varNames.size(), false);
+
+    if (!Executor::ProcBody(line))
+        return false;
+
+    *session.out << "\n(DONE)\n";
+    return true;
+}
@@ -0,0 +1,210 @@
+/*
+ * insource.cpp
+ * Block-buffered input for GET in the SADAL interpreter
+ * CS280 - Spring 2025
+ */
+
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+
+#include "insource.h"
+
+#if defined(_WIN32)
+#include <io.h>
+#define read _read
+#else
+#include <unistd.h>
+#endif
+
+InSource::InSource(int fd, size_t size) : fd(fd), block(size), atEnd(false)
+{
+	cur = end = &block[0];
+}
+
+InSource::InSource(const char* text, size_t len) : fd(-1), atEnd(true)
+{
+	cur = text;
+	end = text + len;
+}
+
+InSource& StdIn()
+{
+	static InSource in(0);
+	return in;
+}
+
+//Read more input after the unread part, keeping the unread part
+//contiguous; false once the descriptor has nothing more
+bool InSource::Fill()
+{
+	if( atEnd )
+		return false;
+	
+	size_t left = end - cur;
+	if( cur != &block[0] )
+		memmove(&block[0], cur, left);
+	if( left == block.size() )
+		block.resize(block.size() * 2);
+	cur = &block[0];
+	end = cur + left;
+	
+	for( ;; )
+	{
+		long n = read(fd, &block[left], block.size() - left);
+		if( n < 0 && errno == EINTR )
+			continue;
+		if( n <= 0 )
+		{
+			atEnd = true;
+			return false;
+		}
+		end += n;
+		return true;
+	}
+}
+
+//Move to the next non-space character; false at the end of input
+bool InSource::SkipSpace()
+{
+	for( ;; )
+	{
+		while( cur < end && isspace((unsigned char) *cur) )
+			cur++;
+		if( cur < end )
+			return true;
+		if( !Fill() )
+			return false;
+	}
+}
+
+//Next whitespace-separated field as [b, e), consumed from the input
+bool InSource::Field(const char*& b, const char*& e)
+{
+	if( !SkipSpace() )
+		return false;
+	
+	size_t n = 0;
+	for( ;; )
+	{
+		while( cur + n < end && !isspace((unsigned char) cur[n]) )
+			n++;
+		if( cur + n < end || !Fill() )
+			break;
+	}
+	b = cur;
+	e = cur + n;
+	cur = e;
+	return true;
+}
+
+InSource::Status InSource::ReadInt(int& v)
+{
+	const char *b, *e;
+	if( !Field(b, e) )
+		return END;
+	
+	bool neg = false;
+	if( b < e && (*b == '+' || *b == '-') )
+		neg = (*b++ == '-');
+	if( b == e )
+		return BAD;
+	
+	long long n = 0;
+	for( ; b < e; b++ )
+	{
+		if( !isdigit((unsigned char) *b) )
+			return BAD;
+		n = n * 10 + (*b - '0');
+		if( n > (long long) INT_MAX + 1 )
+			return BAD;
+	}
+	if( neg )
+		n = -n;
+	if( n > INT_MAX )
+		return BAD;
+	v = (int) n;
+	return GOT;
+}
+
+//[+|-] ( digits [. digits] | . digits ) [ (e|E) [+|-] digits ]
+InSource::Status InSource::ReadReal(double& v)
+{
+	const char *b, *e;
+	if( !Field(b, e) )
+		return END;
+	
+	const char* p = b;
+	size_t digits = 0;
+	if( p < e && (*p == '+' || *p == '-') )
+		p++;
+	for( ; p < e && isdigit((unsigned char) *p); p++ )
+		digits++;
+	if( p < e && *p == '.' )
+	{
+		for( p++; p < e && isdigit((unsigned char) *p); p++ )
+			digits++;
+	}
+	if( digits == 0 )
+		return BAD;
+	if( p < e && (*p == 'e' || *p == 'E') )
+	{
+		p++;
+		if( p < e && (*p == '+' || *p == '-') )
+			p++;
+		if( p == e || !isdigit((unsigned char) *p) )
+			return BAD;
+		while( p < e && isdigit((unsigned char) *p) )
+			p++;
+	}
+	if( p != e )
+		return BAD;
+	
+	//the syntax is checked; strtod does the correctly rounded conversion
+	string text(b, e);
+	errno = 0;
+	double r = strtod(text.c_str(), NULL);
+	if( errno == ERANGE && (r > 1.0 || r < -1.0) )
+		return BAD;
+	v = r;
+	return GOT;
+}
+
+InSource::Status InSource::ReadWord(string& v)
+{
+	const char *b, *e;
+	if( !Field(b, e) )
+		return END;
+	v.assign(b, e);
+	return GOT;
+}
+
+//One character, the first that is not white space
+InSource::Status InSource::ReadChar(char& v)
+{
+	if( !SkipSpace() )
+		return END;
+	v = *cur++;
+	return GOT;
+}
+
+//true or false, in any letter case
+InSource::Status InSource::ReadBool(bool& v)
+{
+	const char *b, *e;
+	if( !Field(b, e) )
+		return END;
+	
+	string word(b, e);
+	for( size_t i = 0; i < word.length(); i++ )
+		word[i] = tolower((unsigned char) word[i]);
+	if( word == "true" )
+		v = true;
+	else if( word == "false" )
+		v = false;
+	else
+		return BAD;
+	return GOT;
+}
@@ -0,0 +1,56 @@
+/*
+ * insource.h
+ * Block-buffered input for GET in the SADAL interpreter
+ *
+ * CS280 - Spring 2025
+ *
+ * An InSource reads a file descriptor in large blocks, or works directly
+ * on text already in memory, and parses whitespace-separated input values
+ * from its buffer. Unlike operator>> it says whether a value was missing
+ * or malformed instead of leaving the target unset.
+*/
+
+#ifndef INSOURCE_H_
+#define INSOURCE_H_
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class InSource {
+	int	fd;		// source descriptor, or -1 for text in memory
+	vector<char> block;
+	const char* cur;	// unread input is [cur, end)
+	const char* end;
+	bool	atEnd;		// nothing more to read from fd
+
+	InSource(const InSource&);
+	InSource& operator=(const InSource&);
+
+	bool	Fill();
+	bool	SkipSpace();
+	bool	Field(const char*& b, const char*& e);
+
+public:
+	static const size_t BlockSize = 1 << 16;
+
+	//outcome of reading one value
+	enum Status { GOT, END, BAD };
+
+	//read from an open file descriptor, e.g. 0 for standard input
+	explicit InSource(int fd, size_t size = BlockSize);
+	//parse text in memory; the text must outlive the InSource
+	InSource(const char* text, size_t len);
+
+	Status	ReadInt(int& v);
+	Status	ReadReal(double& v);
+	Status	ReadWord(string& v);
+	Status	ReadChar(char& v);
+	Status	ReadBool(bool& v);
+};
+
+//Standard input, shared by every Session that does not name its own input
+extern InSource& StdIn();
+
+#endif /* INSOURCE_H_ */
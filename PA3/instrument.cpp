@@ -0,0 +1,105 @@
+/*
+ * instrument.cpp
+ * Counters and phase timers for the SADAL interpreter
+ * CS280 - Spring 2025
+ */
+
+#include <iomanip>
+
+#include "instrument.h"
+
+bool countersBound = false;
+double clockCost = 0;
+thread_local Counters* activeCounters = NULL;
+
+static const char* stmtNames[SC_COUNT] = { "assign", "print", "get", "if" };
+static const char* phaseNames[PH_COUNT] = {
+	"lex", "io", "interpret", "compile", "optimize", "execute", "total"
+};
+
+//Time inside the parsing and executing phases that was not lexing or I/O
+static double ParseEval(const Counters& c)
+{
+	double t = c.seconds[PH_INTERPRET] + c.seconds[PH_COMPILE] + c.seconds[PH_EXECUTE]
+		- c.seconds[PH_LEX] - c.seconds[PH_IO];
+	return t < 0 ? 0 : t;
+}
+
+void CalibrateClock()
+{
+	//the cheapest of a few rounds, so a preemption does not inflate it
+	const int reads = 1000;
+	double best = 1;
+	for( int round = 0; round < 5; round++ )
+	{
+		chrono::steady_clock::time_point first = chrono::steady_clock::now(), last = first;
+		for( int i = 0; i < reads; i++ )
+			last = chrono::steady_clock::now();
+		double each = chrono::duration<double>(last - first).count() / reads;
+		if( each < best )
+			best = each;
+	}
+	clockCost = best;
+}
+
+void Counters::Clear()
+{
+	tokens = pushbacks = lookups = valueCopies = programs = 0;
+	for( int i = 0; i < SC_COUNT; i++ )
+		stmts[i] = 0;
+	for( int i = 0; i < PH_COUNT; i++ )
+		seconds[i] = 0;
+}
+
+void Counters::Merge(const Counters& other)
+{
+	tokens += other.tokens;
+	pushbacks += other.pushbacks;
+	lookups += other.lookups;
+	valueCopies += other.valueCopies;
+	programs += other.programs;
+	for( int i = 0; i < SC_COUNT; i++ )
+		stmts[i] += other.stmts[i];
+	//total is wall-clock time for the whole run, not a sum over threads
+	for( int i = 0; i < PH_TOTAL; i++ )
+		seconds[i] += other.seconds[i];
+}
+
+void Counters::Print(ostream& out) const
+{
+	out << "Programs: " << programs << endl
+		<< "Tokens Lexed: " << tokens << endl
+		<< "Pushbacks: " << pushbacks << endl
+		<< "Variable Lookups: " << lookups << endl
+		<< "Value Copies: " << valueCopies << endl
+		<< "Statements: assign " << stmts[SC_ASSIGN] << ", print " << stmts[SC_PRINT]
+		<< ", get " << stmts[SC_GET] << ", if " << stmts[SC_IF] << endl;
+
+	out << fixed << setprecision(6);
+	out << "Seconds:" << endl;
+	for( int i = 0; i < PH_COUNT; i++ )
+	{
+		//phases the run never entered are left out
+		if( seconds[i] == 0 && i != PH_TOTAL )
+			continue;
+		out << "  " << setw(12) << left << phaseNames[i] << right << seconds[i] << endl;
+	}
+	out << "  " << setw(12) << left << "parse+eval" << right << ParseEval(*this) << endl;
+	out << defaultfloat;
+}
+
+void Counters::PrintJson(ostream& out) const
+{
+	out << "{\"programs\": " << programs
+		<< ", \"tokens\": " << tokens
+		<< ", \"pushbacks\": " << pushbacks
+		<< ", \"lookups\": " << lookups
+		<< ", \"value_copies\": " << valueCopies
+		<< ", \"statements\": {";
+	for( int i = 0; i < SC_COUNT; i++ )
+		out << (i ? ", " : "") << "\"" << stmtNames[i] << "\": " << stmts[i];
+	out << "}, \"seconds\": {" << setprecision(9);
+	for( int i = 0; i < PH_COUNT; i++ )
+		out << "\"" << phaseNames[i] << "\": " << seconds[i] << ", ";
+	out << "\"parse_eval\": " << ParseEval(*this) << "}}" << endl;
+}
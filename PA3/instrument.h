@@ -0,0 +1,101 @@
+/*
+ * instrument.h
+ * Counters and phase timers for the SADAL interpreter
+ *
+ * CS280 - Spring 2025
+ *
+ * Each thread counts into the Counters bound to it with BindCounters().
+ * Nothing is bound unless prog3 is run with -stats or -stats-json, and
+ * then every hook costs one test of a global flag. Time spent
+ * lexing or doing I/O is measured inside the phase that caused it, so
+ * Print() subtracts it again to show what parsing and evaluation took.
+*/
+
+#ifndef INSTRUMENT_H_
+#define INSTRUMENT_H_
+
+#include <iostream>
+#include <chrono>
+
+using namespace std;
+
+//Wall-clock timers; the first two nest inside the others
+enum Phase { PH_LEX, PH_IO, PH_INTERPRET, PH_COMPILE, PH_OPTIMIZE, PH_EXECUTE, PH_TOTAL, PH_COUNT };
+
+//Statements executed, by kind
+enum StmtCount { SC_ASSIGN, SC_PRINT, SC_GET, SC_IF, SC_COUNT };
+
+struct Counters {
+	long	tokens;			// tokens returned by the lexer
+	long	pushbacks;		// tokens pushed back by the parser
+	long	lookups;		// variable table lookups and inserts
+	long	valueCopies;		// Value copy constructions and assignments
+	long	programs;		// programs run
+	long	stmts[SC_COUNT];
+	double	seconds[PH_COUNT];
+
+	Counters() { Clear(); }
+
+	void Clear();
+	//Add other's counts and times to these
+	void Merge(const Counters& other);
+	//Summary table, one line per counter or phase
+	void Print(ostream& out) const;
+	//The same figures as one JSON object
+	void PrintJson(ostream& out) const;
+};
+
+//Set once any thread has bound counters; tested before the thread-local
+//pointer, which is dearer to reach from another translation unit
+extern bool countersBound;
+
+//Seconds a PhaseTimer spends reading the clock, taken off every interval
+extern double clockCost;
+
+//Measure clockCost; called when counters are first bound
+extern void CalibrateClock();
+
+//Counters of the calling thread, or NULL when nothing is counted
+extern thread_local Counters* activeCounters;
+
+inline Counters* ActiveCounters() { return countersBound ? activeCounters : NULL; }
+
+//Count into c on the calling thread, or stop counting with NULL
+inline void BindCounters(Counters* c) {
+	if( c && !countersBound )
+	{
+		CalibrateClock();
+		countersBound = true;
+	}
+	activeCounters = c;
+}
+
+#define INSTR_COUNT(field) do { if( Counters* ic_ = ActiveCounters() ) ic_->field++; } while( 0 )
+
+//Only one token in LexSample is timed, and its time scaled up; reading the
+//clock around every token would take about as long as lexing it
+static const long LexSample = 16;
+
+//Adds the time from construction to destruction, times scale, to one
+//phase of the counters bound when it was constructed
+class PhaseTimer {
+	Counters* c;
+	Phase	phase;
+	double	scale;
+	chrono::steady_clock::time_point start;
+
+public:
+	explicit PhaseTimer(Phase p, double s = 1) : c(ActiveCounters()), phase(p), scale(s) {
+		if( c )
+			start = chrono::steady_clock::now();
+	}
+	~PhaseTimer() {
+		if( !c )
+			return;
+		double t = chrono::duration<double>(chrono::steady_clock::now() - start).count() - clockCost;
+		if( t > 0 )
+			c->seconds[phase] += scale * t;
+	}
+};
+
+#endif /* INSTRUMENT_H_ */
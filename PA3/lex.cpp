@@ -6,43 +6,131 @@
 
 #include <cctype>
 #include <map>
+#include <fstream>
+#include <sstream>
+#include <unordered_set>
+#include <unordered_map>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define LEX_HAVE_MMAP 1
+#endif
+
+//block skip routines use the widest vectors the build targets
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define LEX_HAVE_AVX2 1
+#endif
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define LEX_HAVE_SSE2 1
+#endif
 
 using std::map;
 using namespace std;
 
 #include "lex.h"
-//Keywords or reserved words mapping
-LexItem id_or_kw(const string& lexeme , int linenum)
+//Lexeme pool of each thread; set elements never move, so handing out
+//references is safe. A chunk lexer of Tokenize() interns into a pool its
+//caller owns, which the caller folds into its own once the chunk is done.
+typedef unordered_set<string> LexemePool;
+static thread_local LexemePool ownPool;
+static thread_local LexemePool* lentPool = NULL;
+
+const string& Intern(const string& text)
 {
-	string strlexeme = lexeme;
-	map<string,Token> kwmap = {
-		{ "put", PUT}, { "putline", PUTLN}, { "get", GET},
-		{ "if", IF }, { "elsif", ELSIF }, 
-		{ "else", ELSE },
-		{ "string", STRING },
-		{ "integer", INT },
-		{ "float", FLOAT },
-		{ "character", CHAR },
-		{ "boolean", BOOL },
-		{ "procedure", PROCEDURE }, { "begin", BEGIN },
-		{ "true", TRUE }, { "then", THEN }, { "constant", CONST },
-		{ "false", FALSE }, { "is", IS }, { "end", END },
-		{ "mod", MOD }, { "and", AND }, { "or", OR }, { "not", NOT },
-		
-	};
-	Token tt ;
-	
-	for(int i = 0; i < lexeme.length(); i++)
+	LexemePool& pool = lentPool ? *lentPool : ownPool;
+	auto it = pool.find(text);
+	if( it != pool.end() )
+		return *it;
+	return *pool.insert(text).first;
+}
+
+void ClearInterned()
+{
+	//swap rather than clear() so the bucket array goes too
+	LexemePool().swap(ownPool);
+}
+
+//Case-insensitive match of an identifier against a lower-case keyword of
+//the same length
+static bool KwEq(const char* s, const char* kw, size_t len)
+{
+	for(size_t i = 0; i < len; i++)
 	{
-		strlexeme[i] = tolower(strlexeme[i]);
+		if( tolower((unsigned char) s[i]) != kw[i] )
+			return false;
 	}
+	return true;
+}
+
+//Keywords or reserved words, picked by length and then by first letter
+//so classifying an identifier never allocates
+static Token Keyword(const string& lexeme)
+{
+	const char* s = lexeme.data();
+	size_t len = lexeme.length();
 	
-	tt = IDENT;
-	auto kIt = kwmap.find(strlexeme);
-	if( kIt != kwmap.end() )
-	{
-		tt = kIt->second;
+	switch( len ) {
+	case 2:
+		if( KwEq(s, "if", len) ) return IF;
+		if( KwEq(s, "is", len) ) return IS;
+		if( KwEq(s, "or", len) ) return OR;
+		break;
+	case 3:
+		switch( tolower((unsigned char) s[0]) ) {
+		case 'p': if( KwEq(s, "put", len) ) return PUT; break;
+		case 'g': if( KwEq(s, "get", len) ) return GET; break;
+		case 'e': if( KwEq(s, "end", len) ) return END; break;
+		case 'm': if( KwEq(s, "mod", len) ) return MOD; break;
+		case 'a': if( KwEq(s, "and", len) ) return AND; break;
+		case 'n': if( KwEq(s, "not", len) ) return NOT; break;
+		}
+		break;
+	case 4:
+		if( KwEq(s, "else", len) ) return ELSE;
+		if( KwEq(s, "then", len) ) return THEN;
+		if( KwEq(s, "true", len) ) return TRUE;
+		break;
+	case 5:
+		switch( tolower((unsigned char) s[0]) ) {
+		case 'e': if( KwEq(s, "elsif", len) ) return ELSIF; break;
+		case 'b': if( KwEq(s, "begin", len) ) return BEGIN; break;
+		case 'f':
+			if( KwEq(s, "float", len) ) return FLOAT;
+			if( KwEq(s, "false", len) ) return FALSE;
+			break;
+		}
+		break;
+	case 6:
+		if( KwEq(s, "string", len) ) return STRING;
+		break;
+	case 7:
+		switch( tolower((unsigned char) s[0]) ) {
+		case 'p': if( KwEq(s, "putline", len) ) return PUTLN; break;
+		case 'i': if( KwEq(s, "integer", len) ) return INT; break;
+		case 'b': if( KwEq(s, "boolean", len) ) return BOOL; break;
+		}
+		break;
+	case 8:
+		if( KwEq(s, "constant", len) ) return CONST;
+		break;
+	case 9:
+		if( KwEq(s, "character", len) ) return CHAR;
+		if( KwEq(s, "procedure", len) ) return PROCEDURE;
+		break;
 	}
+	return IDENT;
+}
+
+LexItem id_or_kw(const string& lexeme , int linenum)
+{
+	Token tt = Keyword(lexeme);
 	
 	if(tt == TRUE || tt == FALSE)	
 		tt = BCONST;
@@ -119,13 +207,176 @@ ostream& operator<<(ostream& out, const LexItem& tok) {
 	return out;
 }
 
-LexItem getNextToken(istream& in, int& linenum)
+//Skip routines for the buffer-based lexer. Each one looks at 32 bytes
+//at a time with AVX2, 16 with SSE2, and finishes the tail (or the whole
+//run, on other targets) a byte at a time.
+
+//Blank characters as isspace() sees them in the C locale
+static inline bool IsBlank(char c)
+{
+	return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static inline bool IsAlnum(char c)
+{
+	return (c >= '0' && c <= '9') || ((c | 0x20) >= 'a' && (c | 0x20) <= 'z');
+}
+
+//First character in [p, end) that is not blank; newlines adds the number
+//of new lines skipped
+static const char* SkipBlanks(const char* p, const char* end, int& newlines)
+{
+#ifdef LEX_HAVE_AVX2
+	const __m256i space = _mm256_set1_epi8(' '), nl = _mm256_set1_epi8('\n');
+	const __m256i below = _mm256_set1_epi8('\t' - 1), above = _mm256_set1_epi8('\r' + 1);
+	for( ; end - p >= 32; p += 32 )
+	{
+		__m256i c = _mm256_loadu_si256((const __m256i*) p);
+		__m256i blank = _mm256_or_si256(_mm256_cmpeq_epi8(c, space),
+			_mm256_and_si256(_mm256_cmpgt_epi8(c, below), _mm256_cmpgt_epi8(above, c)));
+		unsigned other = ~(unsigned) _mm256_movemask_epi8(blank);
+		unsigned lines = (unsigned) _mm256_movemask_epi8(_mm256_cmpeq_epi8(c, nl));
+		if( other )
+		{
+			unsigned n = __builtin_ctz(other);
+			newlines += __builtin_popcount(lines & ((1u << n) - 1));
+			return p + n;
+		}
+		newlines += __builtin_popcount(lines);
+	}
+#endif
+#ifdef LEX_HAVE_SSE2
+	const __m128i space16 = _mm_set1_epi8(' '), nl16 = _mm_set1_epi8('\n');
+	const __m128i below16 = _mm_set1_epi8('\t' - 1), above16 = _mm_set1_epi8('\r' + 1);
+	for( ; end - p >= 16; p += 16 )
+	{
+		__m128i c = _mm_loadu_si128((const __m128i*) p);
+		__m128i blank = _mm_or_si128(_mm_cmpeq_epi8(c, space16),
+			_mm_and_si128(_mm_cmpgt_epi8(c, below16), _mm_cmpgt_epi8(above16, c)));
+		unsigned other = ~(unsigned) _mm_movemask_epi8(blank) & 0xFFFF;
+		unsigned lines = (unsigned) _mm_movemask_epi8(_mm_cmpeq_epi8(c, nl16));
+		if( other )
+		{
+			unsigned n = __builtin_ctz(other);
+			newlines += __builtin_popcount(lines & ((1u << n) - 1));
+			return p + n;
+		}
+		newlines += __builtin_popcount(lines);
+	}
+#endif
+	for( ; p != end && IsBlank(*p); p++ )
+		newlines += (*p == '\n');
+	return p;
+}
+
+//First new line in [p, end), or end
+static const char* FindNewline(const char* p, const char* end)
+{
+#ifdef LEX_HAVE_AVX2
+	const __m256i nl = _mm256_set1_epi8('\n');
+	for( ; end - p >= 32; p += 32 )
+	{
+		__m256i c = _mm256_loadu_si256((const __m256i*) p);
+		unsigned lines = (unsigned) _mm256_movemask_epi8(_mm256_cmpeq_epi8(c, nl));
+		if( lines )
+			return p + __builtin_ctz(lines);
+	}
+#endif
+#ifdef LEX_HAVE_SSE2
+	const __m128i nl16 = _mm_set1_epi8('\n');
+	for( ; end - p >= 16; p += 16 )
+	{
+		__m128i c = _mm_loadu_si128((const __m128i*) p);
+		unsigned lines = (unsigned) _mm_movemask_epi8(_mm_cmpeq_epi8(c, nl16));
+		if( lines )
+			return p + __builtin_ctz(lines);
+	}
+#endif
+	for( ; p != end && *p != '\n'; p++ )
+		;
+	return p;
+}
+
+//First character in [p, end) that is not a letter or digit
+static const char* SkipAlnum(const char* p, const char* end)
+{
+#ifdef LEX_HAVE_AVX2
+	const __m256i lower = _mm256_set1_epi8(0x20);
+	const __m256i a = _mm256_set1_epi8('a' - 1), z = _mm256_set1_epi8('z' + 1);
+	const __m256i d0 = _mm256_set1_epi8('0' - 1), d9 = _mm256_set1_epi8('9' + 1);
+	for( ; end - p >= 32; p += 32 )
+	{
+		__m256i c = _mm256_loadu_si256((const __m256i*) p);
+		__m256i l = _mm256_or_si256(c, lower);
+		__m256i alnum = _mm256_or_si256(
+			_mm256_and_si256(_mm256_cmpgt_epi8(l, a), _mm256_cmpgt_epi8(z, l)),
+			_mm256_and_si256(_mm256_cmpgt_epi8(c, d0), _mm256_cmpgt_epi8(d9, c)));
+		unsigned other = ~(unsigned) _mm256_movemask_epi8(alnum);
+		if( other )
+			return p + __builtin_ctz(other);
+	}
+#endif
+#ifdef LEX_HAVE_SSE2
+	const __m128i lower16 = _mm_set1_epi8(0x20);
+	const __m128i a16 = _mm_set1_epi8('a' - 1), z16 = _mm_set1_epi8('z' + 1);
+	const __m128i d016 = _mm_set1_epi8('0' - 1), d916 = _mm_set1_epi8('9' + 1);
+	for( ; end - p >= 16; p += 16 )
+	{
+		__m128i c = _mm_loadu_si128((const __m128i*) p);
+		__m128i l = _mm_or_si128(c, lower16);
+		__m128i alnum = _mm_or_si128(
+			_mm_and_si128(_mm_cmpgt_epi8(l, a16), _mm_cmpgt_epi8(z16, l)),
+			_mm_and_si128(_mm_cmpgt_epi8(c, d016), _mm_cmpgt_epi8(d916, c)));
+		unsigned other = ~(unsigned) _mm_movemask_epi8(alnum) & 0xFFFF;
+		if( other )
+			return p + __builtin_ctz(other);
+	}
+#endif
+	for( ; p != end && IsAlnum(*p); p++ )
+		;
+	return p;
+}
+
+//Hooks the scanner calls to move over runs of blanks, comment text and
+//identifier characters. A stream is left to the character-at-a-time
+//states; a LexBuffer jumps straight to the end of the run.
+static inline void SkipBlankRun(istream&, int&) {}
+static inline void SkipCommentText(istream&) {}
+static inline void TakeAlnumRun(istream&, string&) {}
+
+static inline void SkipBlankRun(LexBuffer& in, int& linenum)
+{
+	in.Seek(SkipBlanks(in.Pos(), in.End(), linenum));
+}
+
+static inline void SkipCommentText(LexBuffer& in)
+{
+	in.Seek(FindNewline(in.Pos(), in.End()));
+}
+
+static inline void TakeAlnumRun(LexBuffer& in, string& lexeme)
+{
+	const char* p = in.Pos();
+	const char* q = SkipAlnum(p, in.End());
+	for( ; p != q; p++ )
+		lexeme += (char) tolower((unsigned char) *p);
+	in.Seek(q);
+}
+
+//The scanner is written once against the get/peek/putback/eof members
+//shared by istream and LexBuffer, so both entry points produce the same
+//token stream.
+template <class Source>
+static LexItem Scan(Source& in, int& linenum)
 {
 	enum TokState { START, INID, INSTR, ININT, INREAL, INEXP, INCHAR, INCOMMENT } lexstate = START;
-	string lexeme, ErrMsg;
+	//scratch text reused across calls so long lexemes do not allocate each time
+	static thread_local string lexeme;
+	string ErrMsg;
 	char ch, nextchar, nextch;
 	Token tt;
 	bool dec = false, intexp = false, floatexp = false;
+	lexeme.clear();
 	       
 	
     while(in.get(ch)) {
@@ -139,13 +390,17 @@ LexItem getNextToken(istream& in, int& linenum)
 			}	
                 
 			if( isspace(ch) )
+			{
+				SkipBlankRun(in, linenum);
 				continue;
+			}
 
 			
 
 			if( isalpha(ch) ) {
 				ch = tolower(ch);
 				lexeme = ch;
+				TakeAlnumRun(in, lexeme);
 				lexstate = INID;
 				
 			}
@@ -282,6 +537,8 @@ LexItem getNextToken(istream& in, int& linenum)
 				{
 					return id_or_kw(lexeme, linenum);
 				}
+				if( ch != '_' )
+					TakeAlnumRun(in, lexeme);
 			}
 			else {
 				in.putback(ch);
@@ -424,6 +681,7 @@ LexItem getNextToken(istream& in, int& linenum)
 					return LexItem(FCONST, lexeme, linenum);
 				}
 			}
+			break;
 								
 		case INCOMMENT:
 			if( ch == '\n' ) {
@@ -431,6 +689,8 @@ LexItem getNextToken(istream& in, int& linenum)
                	linenum++;
 				//in.putback(ch);
 			}
+			else
+				SkipCommentText(in);
 			break;
 		
 		}//end of switch
@@ -441,3 +701,184 @@ LexItem getNextToken(istream& in, int& linenum)
 		
 	return LexItem(ERR, "Error: Some strange symbol", linenum);
 }
+
+LexItem getNextToken(istream& in, int& linenum)
+{
+	return Scan(in, linenum);
+}
+
+LexItem getNextToken(LexBuffer& in, int& linenum)
+{
+	return Scan(in, linenum);
+}
+
+void Tokenize(LexBuffer& in, int& linenum, TokenArray& tokens)
+{
+	const char* start = in.Pos();
+	//room for a token every four bytes; denser sources grow the arrays
+	size_t guess = (in.End() - start) / 4 + 1;
+	tokens.Clear();
+	tokens.kinds.reserve(guess);
+	tokens.offsets.reserve(guess);
+	tokens.lines.reserve(guess);
+	tokens.ids.reserve(guess);
+
+	//lexing goes on after an error, as it would if the parser asked for
+	//more tokens, unless the lexer is stuck on it
+	for( ;; )
+	{
+		const char* before = in.Pos();
+		LexItem tok = Scan(in, linenum);
+		tokens.kinds.push_back((unsigned char)tok.GetToken());
+		tokens.offsets.push_back((unsigned)(in.Pos() - start));
+		tokens.lines.push_back(linenum);
+		tokens.ids.push_back(tok.GetSymbol());
+		if( tok == DONE || (tok == ERR && in.Pos() == before) )
+			break;
+	}
+}
+
+//Sources shorter than this per thread are not worth splitting
+static const size_t MinChunk = 256 * 1024;
+
+//Where the chunk lexers start: just past a new line near each even share
+//of [start, end). No token goes past a new line, since one ends a bad
+//string or character constant and a comment too, so the lexer is always
+//back in START after it. Returns the start of every chunk and then end.
+static vector<const char*> ChunkCuts(const char* start, const char* end, unsigned jobs)
+{
+	size_t len = end - start;
+	if( jobs > len / MinChunk )
+		jobs = (unsigned)(len / MinChunk);
+	vector<const char*> cuts(1, start);
+	for( unsigned i = 1; i < jobs; i++ )
+	{
+		const char* cut = FindNewline(start + len / jobs * i, end);
+		if( cut != end && cut + 1 > cuts.back() )
+			cuts.push_back(cut + 1);
+	}
+	cuts.push_back(end);
+	return cuts;
+}
+
+void Tokenize(LexBuffer& in, int& linenum, TokenArray& tokens, unsigned jobs)
+{
+	const char* start = in.Pos();
+	vector<const char*> cuts = ChunkCuts(start, in.End(), jobs);
+	size_t chunks = cuts.size() - 1;
+	if( chunks < 2 )
+	{
+		Tokenize(in, linenum, tokens);
+		return;
+	}
+
+	//each chunk is lexed from line 0, so its line count at the end is
+	//the number of new lines the lexer counted in it. The first chunk is
+	//lexed on this thread; the others intern into pools of their own.
+	vector<TokenArray> parts(chunks);
+	vector<int> counted(chunks, 0);
+	vector<LexemePool> pools(chunks);
+	auto lex = [&](size_t k) {
+		if( k > 0 )
+			lentPool = &pools[k];
+		LexBuffer chunk(cuts[k], cuts[k + 1] - cuts[k]);
+		Tokenize(chunk, counted[k], parts[k]);
+		lentPool = NULL;
+	};
+	vector<thread> pool;
+	for( size_t k = 1; k < chunks; k++ )
+		pool.push_back(thread(lex, k));
+	lex(0);
+	for( thread& t : pool )
+		t.join();
+
+	//stitch the chunks together, dropping the DONE that ends all but the
+	//last, and move their offsets and lines to where the chunk starts
+	size_t total = 0;
+	for( const TokenArray& part : parts )
+		total += part.Size();
+	tokens.Clear();
+	tokens.kinds.reserve(total);
+	tokens.offsets.reserve(total);
+	tokens.lines.reserve(total);
+	tokens.ids.reserve(total);
+	for( size_t k = 0; k < chunks; k++ )
+	{
+		const TokenArray& part = parts[k];
+		size_t n = k + 1 < chunks ? part.Size() - 1 : part.Size();
+		unsigned offset = (unsigned)(cuts[k] - start);
+		tokens.kinds.insert(tokens.kinds.end(), part.kinds.begin(), part.kinds.begin() + n);
+		if( k == 0 )
+			tokens.ids.insert(tokens.ids.end(), part.ids.begin(), part.ids.begin() + n);
+		else
+		{
+			//move the chunk's lexemes over to this thread's pool
+			unordered_map<const string*, const string*> mine;
+			for( const string& s : pools[k] )
+				mine[&s] = &Intern(s);
+			for( size_t i = 0; i < n; i++ )
+				tokens.ids.push_back(mine[part.ids[i]]);
+		}
+		for( size_t i = 0; i < n; i++ )
+		{
+			tokens.offsets.push_back(part.offsets[i] + offset);
+			tokens.lines.push_back(part.lines[i] + linenum);
+		}
+		linenum += counted[k];
+	}
+	in.Seek(in.End());
+}
+
+bool SourceMap::Open(const string& path)
+{
+	Close();
+#ifdef LEX_HAVE_MMAP
+	int fd = open(path.c_str(), O_RDONLY);
+	if( fd < 0 )
+		return false;
+	
+	struct stat st;
+	if( fstat(fd, &st) == 0 && S_ISREG(st.st_mode) )
+	{
+		len = st.st_size;
+		if( len == 0 )
+		{
+			::close(fd);
+			return true;
+		}
+		void* p = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+		if( p != MAP_FAILED )
+		{
+			::close(fd);
+			data = (char*) p;
+			mapped = true;
+			return true;
+		}
+	}
+	::close(fd);
+	len = 0;
+#endif
+	//not mappable (pipe, special file, no mmap): read it into memory instead
+	ifstream file(path.c_str(), ios::in | ios::binary);
+	if( !file.is_open() )
+		return false;
+	
+	ostringstream text;
+	text << file.rdbuf();
+	copy = text.str();
+	data = (char*) copy.data();
+	len = copy.size();
+	return true;
+}
+
+void SourceMap::Close()
+{
+#ifdef LEX_HAVE_MMAP
+	if( mapped )
+		munmap(data, len);
+#endif
+	copy.clear();
+	data = NULL;
+	len = 0;
+	mapped = false;
+}
@@ -11,6 +11,8 @@
 #include <string>
 #include <iostream>
 #include <map>
+#include <vector>
+#include <cstdio>
 using namespace std;
 
 
@@ -37,20 +39,39 @@ enum Token {
 };
 
 
+//Returns the calling thread's single copy of text, so equal lexemes are
+//stored once and compare equal by address. Copies live until the thread
+//calls ClearInterned(); each run of a program starts with one.
+extern const string& Intern(const string& text);
+
+//Forget every lexeme the calling thread interned; no LexItem it made
+//before may be used afterwards
+extern void ClearInterned();
+
 //Class definition of LexItem
+//The lexeme is interned, so copying a LexItem never allocates
 class LexItem {
 	Token	token;
-	string	lexeme;
+	const string* lexeme;
 	int	lnum;
 
 public:
 	LexItem() {
+		//not interned, so it outlives ClearInterned()
+		static const string empty;
 		token = ERR;
+		lexeme = &empty;
 		lnum = -1;
 	}
-	LexItem(Token token, string lexeme, int line) {
+	LexItem(Token token, const string& lexeme, int line) {
 		this->token = token;
-		this->lexeme = lexeme;
+		this->lexeme = &Intern(lexeme);
+		this->lnum = line;
+	}
+	//symbol must already be interned
+	LexItem(Token token, const string* symbol, int line) {
+		this->token = token;
+		this->lexeme = symbol;
 		this->lnum = line;
 	}
 
@@ -58,15 +79,93 @@ public:
 	bool operator!=(const Token token) const { return this->token != token; }
 
 	Token	GetToken() const { return token; }
-	string	GetLexeme() const { return lexeme; }
+	const string& GetLexeme() const { return *lexeme; }
+	const string* GetSymbol() const { return lexeme; }
 	int	GetLinenum() const { return lnum; }
 };
 
 
+//Cursor over contiguous source text, for the buffer-based lexer.
+//The text is not owned and must outlive the buffer.
+class LexBuffer {
+	const char*	cur;
+	const char*	end;
+
+public:
+	LexBuffer() {
+		cur = end = NULL;
+	}
+	LexBuffer(const char* text, size_t len) {
+		cur = text;
+		end = text + len;
+	}
+	LexBuffer(const string& text) {
+		cur = text.data();
+		end = text.data() + text.size();
+	}
+
+	//same contract as the istream members the lexer uses
+	bool	get(char& ch) { if( cur == end ) return false; ch = *cur++; return true; }
+	int	peek() const { return cur == end ? EOF : (unsigned char)*cur; }
+	void	putback(char) { --cur; }
+	bool	eof() const { return cur == end; }
+
+	//direct access for the lexer's block skip routines
+	const char* Pos() const { return cur; }
+	const char* End() const { return end; }
+	void	Seek(const char* pos) { cur = pos; }
+};
+
+//Whole source file held in memory; memory-mapped where the platform allows
+class SourceMap {
+	char*	data;
+	size_t	len;
+	bool	mapped;
+	string	copy;
+
+	SourceMap(const SourceMap&);
+	SourceMap& operator=(const SourceMap&);
+
+public:
+	SourceMap() {
+		data = NULL;
+		len = 0;
+		mapped = false;
+	}
+	~SourceMap() { Close(); }
+
+	bool	Open(const string& path);
+	void	Close();
+	LexBuffer Buffer() const { return LexBuffer(data, len); }
+	const char* Data() const { return data; }
+	size_t	Length() const { return len; }
+};
+
+//A whole source lexed up front, one entry per token, kept as parallel
+//arrays so the parser can walk it by index. The last entry is DONE, or an
+//ERR the lexer could not get past.
+class TokenArray {
+public:
+	vector<unsigned char> kinds;	// Token
+	vector<unsigned> offsets;	// source offset just past the token
+	vector<int>	lines;		// line count after the token
+	vector<const string*> ids;	// interned lexeme
+
+	size_t	Size() const { return kinds.size(); }
+	LexItem	Item(size_t i) const { return LexItem((Token)kinds[i], ids[i], lines[i]); }
+	void	Clear() { kinds.clear(); offsets.clear(); lines.clear(); ids.clear(); }
+};
+
 
 extern ostream& operator<<(ostream& out, const LexItem& tok);
 extern LexItem id_or_kw(const string& lexeme, int linenum);
 extern LexItem getNextToken(istream& in, int& linenum);
+extern LexItem getNextToken(LexBuffer& in, int& linenum);
+//Lex all of in into tokens, up to and including DONE
+extern void Tokenize(LexBuffer& in, int& linenum, TokenArray& tokens);
+//The same, with large sources cut at new lines into up to jobs chunks
+//lexed on their own threads
+extern void Tokenize(LexBuffer& in, int& linenum, TokenArray& tokens, unsigned jobs);
 
 
 #endif /* LEX_H_ */
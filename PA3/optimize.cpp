@@ -0,0 +1,285 @@
+/* Optimization passes over compiled SADAL procedures
+ * optimize.cpp
+ *
+ * CS280 - Spring 2025
+ *
+ * Rewrites the node pools built by Compile() before Execute() runs them.
+ * A subtree is only replaced when evaluating it at run time could not
+ * fail, so a failing program still prints the same error cascade.
+ */
+
+#include <vector>
+#include "ast.h"
+
+using namespace std;
+
+namespace Optimizer {
+
+static thread_local CompiledProg* prog;
+
+// consts index of every CONSTANT variable whose initializer folded, by
+// slot, or -1
+static thread_local vector<int> constOf;
+
+static bool Fold(int node);
+
+// Value of a node that is a literal
+static const Value& ConstValue(int node)
+{
+    return prog->consts[prog->exprs[node].a];
+}
+
+// Turn a node into the literal consts[c]; its old operands are left unused
+static bool ShareConst(int node, int c)
+{
+    ExprNode& n = prog->exprs[node];
+    n.kind = N_CONST;
+    n.a = c;
+    n.b = -1;
+    n.slot = -1;
+    return true;
+}
+
+// Turn a node into a literal holding v, which must not be in consts
+static bool MakeConst(int node, const Value& v)
+{
+    if (v.IsErr()) return false;
+    prog->consts.push_back(v);
+    return ShareConst(node, (int)prog->consts.size() - 1);
+}
+
+// Result of a op b, as Binary() in exec.cpp computes it; false wherever
+// Binary() would report a run-time error
+static bool BinaryValue(Token op, const Value& left, const Value& right, Value & retVal)
+{
+    switch (op) {
+        case AND: case OR:
+            retVal = right;
+            return true;
+
+        case EQ:    retVal = left == right; return true;
+        case NEQ:   retVal = left != right; return true;
+        case LTHAN: retVal = left <  right; return true;
+        case LTE:   retVal = left <= right; return true;
+        case GTHAN: retVal = left >  right; return true;
+        case GTE:   retVal = left >= right; return true;
+
+        case CONCAT:
+            retVal = left;
+            retVal.Append(right);
+            return true;
+
+        case PLUS: case MINUS: case MULT: case DIV: {
+            bool bothInt  = left.IsInt()  && right.IsInt();
+            bool bothReal = left.IsReal() && right.IsReal();
+            if (!(bothInt || bothReal)) return false;
+            if (op == DIV && (bothInt ? right.GetInt() == 0 : right.GetReal() == 0.0)) return false;
+            if (op == PLUS)       retVal = left + right;
+            else if (op == MINUS) retVal = left - right;
+            else if (op == MULT)  retVal = left * right;
+            else                  retVal = left / right;
+            return true;
+        }
+
+        case MOD:
+            if (!(left.IsInt() && right.IsInt()) || right.GetInt() == 0) return false;
+            retVal = left % right;
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+// Name ( Range ) on a known string; false wherever Name() would fail
+static bool SubstrValue(const Value& baseVal, const ExprNode& range, Value & retVal)
+{
+    const Value& loVal = ConstValue(range.a);
+    if (!loVal.IsInt()) return false;
+    const Value& hiVal = range.b < 0 ? loVal : ConstValue(range.b);
+    if (!hiVal.IsInt() || !baseVal.IsString()) return false;
+
+    const string& s = baseVal.GetString();
+    int lo = loVal.GetInt(), hi = hiVal.GetInt();
+    if (lo > hi || lo < 0 || hi >= (int)s.size()) return false;
+    if (lo == hi) {
+        retVal = Value(s[lo]);
+    } else {
+        retVal = Value(s.substr(lo, hi - lo + 1));
+    }
+    return true;
+}
+
+// Fold the operands of a range; a range is never a value on its own
+static bool FoldRange(int node)
+{
+    const ExprNode& n = prog->exprs[node];
+    int lo = n.a, hi = n.b;
+    bool known = Fold(lo);
+    if (hi >= 0) known = Fold(hi) && known;
+    return known;
+}
+
+// Fold the subtree at node bottom up; true if it is now a literal
+static bool Fold(int node)
+{
+    ExprNode& n = prog->exprs[node];
+    int a = n.a, b = n.b;
+    switch (n.kind) {
+        case N_CONST:
+            return true;
+
+        case N_VAR:
+            if (constOf[n.slot] < 0) return false;
+            return ShareConst(node, constOf[n.slot]);
+
+        case N_SUBSTR: {
+            if (!FoldRange(a) || constOf[n.slot] < 0) return false;
+            Value v;
+            return SubstrValue(prog->consts[constOf[n.slot]], prog->exprs[a], v) && MakeConst(node, v);
+        }
+
+        case N_PAREN:
+            if (!Fold(a)) return false;
+            return ShareConst(node, prog->exprs[a].a);
+
+        case N_NOT:
+            if (!Fold(a)) return false;
+            return MakeConst(node, !ConstValue(a));
+
+        case N_EXP: {
+            bool known = Fold(a);
+            known = Fold(b) && known;
+            if (!known) return false;
+            const Value& base = ConstValue(a);
+            const Value& exponent = ConstValue(b);
+            if (!base.IsReal() || !exponent.IsReal()) return false;
+            return MakeConst(node, base.Exp(exponent));
+        }
+
+        // the sign is only type-checked, as in STerm
+        case N_SIGN: {
+            if (!Fold(a)) return false;
+            const Value& v = ConstValue(a);
+            if (!(v.IsInt() || v.IsReal())) return false;
+            return ShareConst(node, prog->exprs[a].a);
+        }
+
+        case N_BINARY: {
+            bool known = Fold(a);
+            known = Fold(b) && known;
+            if (!known) return false;
+            Value v;
+            return BinaryValue(n.op, ConstValue(a), ConstValue(b), v) && MakeConst(node, v);
+        }
+
+        default:
+            return false;
+    }
+}
+
+// True if node is a literal boolean, which is then stored in b
+static bool ConstBool(int node, bool& b)
+{
+    if (node < 0) return false;
+    const ExprNode& n = prog->exprs[node];
+    if (n.kind != N_CONST || !prog->consts[n.a].IsBool()) return false;
+    b = prog->consts[n.a].GetBool();
+    return true;
+}
+
+// Drop the arms of an IF statement that can never run, given the
+// conditions that folded to literals. Every ELSIF condition is still
+// evaluated at run time, so an arm whose condition could fail is kept
+// and only its body is emptied; a body that never runs is the range
+// [end, end).
+static void PruneIf(StmtNode& st)
+{
+    IfArm* arms = &prog->arms[st.arm];
+    bool b;
+    if (ConstBool(arms[0].cond, b)) {
+        if (b) {
+            // the ELSIF conditions are not evaluated after a true IF
+            st.narms = 1;
+            return;
+        }
+        arms[0].first = arms[0].end;
+    }
+
+    int taken = -1;		// first ELSIF arm whose condition is literally true
+    bool known = true;	// every ELSIF condition after it is a literal boolean
+    int i = 1;
+    for (; i < st.narms && arms[i].cond >= 0; i++) {
+        bool isBool = ConstBool(arms[i].cond, b);
+        if (taken >= 0) {
+            known = known && isBool;
+            arms[i].first = arms[i].end;
+        } else if (isBool && b) {
+            taken = i;
+        } else if (isBool) {
+            arms[i].first = arms[i].end;
+        }
+    }
+    if (taken < 0) return;
+
+    // no arm after the taken one runs; drop them if nothing is left to check
+    if (i < st.narms) arms[i].first = arms[i].end;
+    if (known) st.narms = taken + 1;
+}
+
+// Fold the expressions of the statements in stmts[first, end) and
+// remove the IF arms that can never run
+static void FoldStmts(int first, int end)
+{
+    for (int s = first; s < end; s = prog->stmts[s].next) {
+        StmtNode& st = prog->stmts[s];
+        if (st.kind == S_ASSIGN || st.kind == S_PRINT) {
+            Fold(st.expr);
+        } else if (st.kind == S_IF) {
+            for (int i = st.arm; i < st.arm + st.narms; i++) {
+                if (prog->arms[i].cond >= 0) Fold(prog->arms[i].cond);
+            }
+            PruneIf(st);
+            for (int i = st.arm; i < st.arm + st.narms; i++) {
+                FoldStmts(prog->arms[i].first, prog->arms[i].end);
+            }
+        }
+    }
+}
+
+} // namespace Optimizer
+
+// Evaluate literal-only subexpressions once and replace them by their
+// values. A CONSTANT variable whose initializer folds and which is never
+// the target of an assignment or GET is replaced by its value in the
+// declarations after its own and in every statement. IF arms whose
+// conditions settle which branch runs are then cut down to that branch.
+void Optimize(CompiledProg& prog)
+{
+    using namespace Optimizer;
+    Optimizer::prog = &prog;
+    constOf.assign(prog.varNames.size(), -1);
+
+    vector<bool> written(prog.varNames.size(), false);
+    for (size_t s = 0; s < prog.stmts.size(); s++) {
+        const StmtNode& st = prog.stmts[s];
+        if (st.kind == S_ASSIGN || st.kind == S_GET)
+            written[st.slot] = true;
+    }
+
+    for (size_t d = 0; d < prog.decls.size(); d++) {
+        const DeclNode& decl = prog.decls[d];
+        if (decl.range >= 0) FoldRange(decl.range);
+        if (decl.init < 0) continue;
+        if (Fold(decl.init) && decl.isConst) {
+            for (int v : decl.slots) {
+                if (!written[v]) constOf[v] = prog.exprs[decl.init].a;
+            }
+        }
+    }
+
+    if (!prog.stmts.empty())
+        FoldStmts(0, (int)prog.stmts.size());
+
+    constOf.clear();
+}
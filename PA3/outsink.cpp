@@ -0,0 +1,107 @@
+/*
+ * outsink.cpp
+ * Block-buffered output for the SADAL interpreter
+ * CS280 - Spring 2025
+ */
+
+#include <cerrno>
+#include <cstring>
+
+#include "outsink.h"
+
+#if defined(_WIN32)
+#include <io.h>
+#define write _write
+#else
+#include <unistd.h>
+#endif
+
+//write(2) all of p, retrying after interrupts and short writes
+static bool WriteAll(int fd, const char* p, size_t left)
+{
+	while( left > 0 )
+	{
+		long n = write(fd, p, left);
+		if( n < 0 )
+		{
+			if( errno == EINTR )
+				continue;
+			return false;
+		}
+		p += n;
+		left -= n;
+	}
+	return true;
+}
+
+OutBuf::OutBuf(int fd, size_t size) : fd(fd), mem(NULL), block(size)
+{
+	setp(&block[0], &block[0] + block.size());
+}
+
+OutBuf::OutBuf(string& mem, size_t size) : fd(-1), mem(&mem), block(size)
+{
+	setp(&block[0], &block[0] + block.size());
+}
+
+OutBuf::~OutBuf()
+{
+	Drain();
+}
+
+//Hand the buffered bytes to the destination and empty the block
+bool OutBuf::Drain()
+{
+	const char* p = pbase();
+	size_t left = pptr() - pbase();
+	
+	setp(&block[0], &block[0] + block.size());
+	if( mem != NULL )
+	{
+		mem->append(p, left);
+		return true;
+	}
+	return WriteAll(fd, p, left);
+}
+
+OutBuf::int_type OutBuf::overflow(int_type ch)
+{
+	if( !Drain() )
+		return traits_type::eof();
+	if( ch != traits_type::eof() )
+	{
+		*pptr() = ch;
+		pbump(1);
+	}
+	return traits_type::not_eof(ch);
+}
+
+//Copy into the block; text larger than the block goes straight through
+streamsize OutBuf::xsputn(const char* s, streamsize n)
+{
+	streamsize room = epptr() - pptr();
+	if( n <= room )
+	{
+		memcpy(pptr(), s, n);
+		pbump((int) n);
+		return n;
+	}
+	if( !Drain() )
+		return 0;
+	if( (size_t) n >= block.size() )
+	{
+		if( mem != NULL )
+			mem->append(s, n);
+		else if( !WriteAll(fd, s, n) )
+			return 0;
+		return n;
+	}
+	memcpy(pptr(), s, n);
+	pbump((int) n);
+	return n;
+}
+
+int OutBuf::sync()
+{
+	return Drain() ? 0 : -1;
+}
@@ -0,0 +1,55 @@
+/*
+ * outsink.h
+ * Block-buffered output for the SADAL interpreter
+ *
+ * CS280 - Spring 2025
+ *
+ * An OutSink is an ostream that collects output in a fixed-size block and
+ * only hands it on when the block fills up or flush() is called, either
+ * to a file descriptor with write(2) or to a string in memory. It can be
+ * used anywhere an ostream is, in particular as a Session's output.
+*/
+
+#ifndef OUTSINK_H_
+#define OUTSINK_H_
+
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+//Buffer behind an OutSink
+class OutBuf : public streambuf {
+	int	fd;		// destination descriptor, or -1
+	string*	mem;		// destination string when fd is -1
+	vector<char> block;
+
+	bool	Drain();
+
+protected:
+	virtual int_type overflow(int_type ch);
+	virtual streamsize xsputn(const char* s, streamsize n);
+	virtual int sync();
+
+public:
+	OutBuf(int fd, size_t size);
+	OutBuf(string& mem, size_t size);
+	~OutBuf();
+};
+
+class OutSink : public ostream {
+	OutBuf	buf;
+
+public:
+	static const size_t BlockSize = 1 << 16;
+
+	//write to an open file descriptor, e.g. 1 for standard output
+	explicit OutSink(int fd, size_t size = BlockSize) : ostream(NULL), buf(fd, size) { rdbuf(&buf); }
+	//append to a string
+	explicit OutSink(string& mem, size_t size = BlockSize) : ostream(NULL), buf(mem, size) { rdbuf(&buf); }
+	~OutSink() { flush(); }
+};
+
+#endif /* OUTSINK_H_ */
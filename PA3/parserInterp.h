@@ -8,11 +8,67 @@
 #define PARSER_H_
 
 #include <iostream>
+#include <string>
+#include <vector>
+#include <queue>
+#include <unordered_map>
 
 using namespace std;
 
 #include "lex.h"
 #include "val.h"
+#include "insource.h"
+#include "tokstream.h"
+
+//Everything the interpreter keeps while it runs one program. Each thread
+//interprets through the Session bound to it, so programs running on
+//different threads never share state.
+class Session {
+public:
+	unordered_map<const string*, int> defVar;	// interned var → slot
+	vector<Token>	SymTable;		// slot → type
+	vector<Value>	TempsResults;		// slot → current value
+	vector<bool>	Assigned;		// slot → holds a value
+	vector<string>	SlotNames;		// slot → var
+	queue<int>	Ids_List;		// helper for DeclStmt
+
+	bool	failureInDeclPart;
+	bool	inAssignStmt;
+	string	currentProcName;
+
+	TokenStream<istream> tokens;		// Parser lookahead
+
+	int	error_count;
+
+	ostream* out;				// PUT/PUTLN output and error messages
+	InSource* in;				// GET input
+
+	Session(ostream& o = cout, InSource& i = StdIn()) {
+		out = &o;
+		in = &i;
+		Reset();
+	}
+
+	//forget the previous program; the streams are kept
+	void Reset() {
+		defVar.clear();
+		SymTable.clear();
+		TempsResults.clear();
+		Assigned.clear();
+		SlotNames.clear();
+		Ids_List = queue<int>();
+		failureInDeclPart = false;
+		inAssignStmt = false;
+		currentProcName.clear();
+		tokens.Clear();
+		error_count = 0;
+	}
+};
+
+//Session of the calling thread; a thread that never bound one gets its own
+extern Session& CurSession();
+//Bind s to the calling thread, or go back to the thread's own session with NULL
+extern void BindSession(Session* s);
 
 extern bool Prog(istream& in, int& line);
 extern bool ProcBody(istream& in, int& line);
@@ -26,7 +82,7 @@ extern bool PrintStmts(istream& in, int& line);
 extern bool GetStmt(istream& in, int& line);
 extern bool IfStmt(istream& in, int& line);
 extern bool AssignStmt(istream& in, int& line);
-extern bool Var(istream& in, int& line, LexItem & idtok);
+extern bool Var(istream& in, int& line, int & slot);
 extern bool Expr(istream& in, int& line, Value & retVal);
 extern bool Relation(istream& in, int& line, Value & retVal);
 extern bool SimpleExpr(istream& in, int& line, Value & retVal);
@@ -37,6 +93,9 @@ extern bool Primary(istream& in, int& line, int sign, Value & retVal);
 extern bool Name(istream& in, int& line, int sign, Value & retVal);
 extern bool Range(istream& in, int& line, Value & retVal1, Value & retVal2);
 
+extern bool ReadInput(int line, Token type, Value & val);
+
 extern int ErrCount();
+extern void ResetInterp();
 
 #endif /* PARSE_H_ */
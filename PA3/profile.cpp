@@ -0,0 +1,187 @@
+/*
+ * profile.cpp
+ * Statement-level profile of SADAL programs
+ * CS280 - Spring 2025
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <tuple>
+
+#include "profile.h"
+#include "instrument.h"
+
+bool profileBound = false;
+thread_local Profile* activeProfile = NULL;
+
+static const char* kindNames[PK_COUNT] = {
+	"program", "assign", "put", "get", "if", "then", "elsif", "else"
+};
+
+void BindProfile(Profile* p)
+{
+	if( p && !profileBound )
+	{
+		//the time each clock read takes is subtracted as for the counters
+		CalibrateClock();
+		profileBound = true;
+	}
+	activeProfile = p;
+}
+
+Profile::Profile() : cur(0)
+{
+	nodes.push_back(Node(PK_PROGRAM, -1, -1));
+}
+
+//The child of parent for kind and line, made on first use
+int Profile::Child(int parent, ProfKind kind, int line)
+{
+	unsigned long long key = ((unsigned long long)parent << 32) | ((unsigned long long)kind << 28)
+		| (unsigned)(line & 0x0fffffff);
+	auto found = index.find(key);
+	if( found != index.end() )
+		return found->second;
+
+	int n = (int)nodes.size();
+	nodes.push_back(Node(kind, line, parent));
+	nodes[parent].children.push_back(n);
+	index[key] = n;
+	return n;
+}
+
+void Profile::Enter(ProfKind kind, int line)
+{
+	cur = Child(cur, kind, line);
+	nodes[cur].count++;
+	//read the clock last so the lookup above is charged to the parent
+	started.push_back(chrono::steady_clock::now());
+}
+
+void Profile::EnterProgram(const string& name)
+{
+	size_t i = find(programs.begin(), programs.end(), name) - programs.begin();
+	if( i == programs.size() )
+		programs.push_back(name);
+	Enter(PK_PROGRAM, (int)i);
+}
+
+void Profile::Leave()
+{
+	double t = chrono::duration<double>(chrono::steady_clock::now() - started.back()).count() - clockCost;
+	started.pop_back();
+	if( t > 0 )
+		nodes[cur].seconds += t;
+	cur = nodes[cur].parent;
+}
+
+//Time spent in node itself and not in its children
+double Profile::Self(int node) const
+{
+	double t = nodes[node].seconds;
+	for( int c : nodes[node].children )
+		t -= nodes[c].seconds;
+	return t < 0 ? 0 : t;
+}
+
+string Profile::Frame(int node) const
+{
+	const Node& n = nodes[node];
+	if( n.kind == PK_PROGRAM )
+		return programs[n.line];
+	ostringstream frame;
+	frame << kindNames[n.kind] << ":" << n.line;
+	return frame.str();
+}
+
+void Profile::MergeNode(const Profile& other, int theirs, int mine)
+{
+	for( int c : other.nodes[theirs].children )
+	{
+		const Node& from = other.nodes[c];
+		int line = from.line;
+		if( from.kind == PK_PROGRAM )
+		{
+			const string& name = other.programs[line];
+			line = (int)(find(programs.begin(), programs.end(), name) - programs.begin());
+			if( line == (int)programs.size() )
+				programs.push_back(name);
+		}
+		int to = Child(mine, from.kind, line);
+		nodes[to].count += from.count;
+		nodes[to].seconds += from.seconds;
+		MergeNode(other, c, to);
+	}
+}
+
+void Profile::Merge(const Profile& other)
+{
+	MergeNode(other, 0, 0);
+}
+
+void Profile::HotSpots(ostream& out) const
+{
+	//one row per program, line and kind; the same line can be reached
+	//along more than one path once profiles are merged
+	struct Row { long count; double self; double total; };
+	map<tuple<string, int, int>, Row> rows;
+	double all = 0;
+	for( int c : nodes[0].children )
+		all += nodes[c].seconds;
+
+	for( size_t i = 1; i < nodes.size(); i++ )
+	{
+		const Node& n = nodes[i];
+		if( n.kind == PK_PROGRAM || n.kind == PK_THEN || n.kind == PK_ELSIF || n.kind == PK_ELSE )
+			continue;
+		int prog = (int)i;
+		while( nodes[prog].kind != PK_PROGRAM )
+			prog = nodes[prog].parent;
+		Row& r = rows[make_tuple(programs[nodes[prog].line], n.line, (int)n.kind)];
+		r.count += n.count;
+		r.self += Self((int)i);
+		r.total += n.seconds;
+	}
+
+	vector<pair<Row, tuple<string, int, int> > > sorted;
+	for( auto& r : rows )
+		sorted.push_back(make_pair(r.second, r.first));
+	stable_sort(sorted.begin(), sorted.end(),
+		[](const pair<Row, tuple<string, int, int> >& a, const pair<Row, tuple<string, int, int> >& b) {
+			return a.first.self > b.first.self;
+		});
+
+	out << "Hot Spots: " << sorted.size() << " statements, " << fixed << setprecision(6) << all
+		<< " seconds" << endl;
+	out << setw(12) << "Self(s)" << setw(8) << "Self%" << setw(12) << "Total(s)" << setw(10) << "Count"
+		<< "  Statement" << endl;
+	for( auto& s : sorted )
+	{
+		out << setw(12) << s.first.self
+			<< setw(7) << setprecision(1) << (all > 0 ? 100 * s.first.self / all : 0) << "%"
+			<< setw(12) << setprecision(6) << s.first.total
+			<< setw(10) << s.first.count
+			<< "  " << get<0>(s.second) << ":" << get<1>(s.second) << " " << kindNames[get<2>(s.second)]
+			<< endl;
+	}
+	out << defaultfloat;
+}
+
+void Profile::Fold(ostream& out, int node, const string& path) const
+{
+	string here = path.empty() ? Frame(node) : path + ";" + Frame(node);
+	long long ns = llround(Self(node) * 1e9);
+	if( ns > 0 )
+		out << here << " " << ns << "\n";
+	for( int c : nodes[node].children )
+		Fold(out, c, here);
+}
+
+void Profile::Folded(ostream& out) const
+{
+	for( int c : nodes[0].children )
+		Fold(out, c, "");
+}
@@ -0,0 +1,103 @@
+/*
+ * profile.h
+ * Statement-level profile of SADAL programs
+ *
+ * CS280 - Spring 2025
+ *
+ * A Profile is a calling-context tree: the root has one child per program
+ * run, and every statement executed is a node under the program, or under
+ * the arm of the IF that ran it. Each node keeps how often it was entered
+ * and the wall-clock time spent inside it; a node's own time is what is
+ * left after its children. Like the counters in instrument.h a Profile is
+ * bound to a thread, and nothing is bound unless prog3 is run with
+ * -profile or -profile-folded.
+*/
+
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+
+using namespace std;
+
+//What a node of the profile stands for
+enum ProfKind { PK_PROGRAM, PK_ASSIGN, PK_PRINT, PK_GET, PK_IF, PK_THEN, PK_ELSIF, PK_ELSE, PK_COUNT };
+
+class Profile {
+	struct Node {
+		ProfKind kind;
+		int	line;			// source line; program index for PK_PROGRAM
+		int	parent;
+		long	count;
+		double	seconds;		// including the children
+		vector<int> children;
+
+		Node(ProfKind k, int ln, int p) : kind(k), line(ln), parent(p), count(0), seconds(0) {}
+	};
+
+	vector<Node> nodes;			// nodes[0] is the root
+	vector<string> programs;		// names of the PK_PROGRAM nodes
+	unordered_map<unsigned long long, int> index;	// (parent, kind, line) → node
+	int	cur;				// innermost node entered
+	vector<chrono::steady_clock::time_point> started;	// entry time of each open node
+
+	int	Child(int parent, ProfKind kind, int line);
+	double	Self(int node) const;
+	string	Frame(int node) const;
+	void	Fold(ostream& out, int node, const string& path) const;
+	void	MergeNode(const Profile& other, int theirs, int mine);
+
+public:
+	Profile();
+
+	//Enter a statement or IF arm as a child of the innermost open node
+	void	Enter(ProfKind kind, int line);
+	//Enter a program; programs are run one at a time from the root
+	void	EnterProgram(const string& name);
+	//Leave the innermost open node, adding the time since Enter()
+	void	Leave();
+
+	//Add other's nodes to these, matching programs by name
+	void	Merge(const Profile& other);
+	//Statements sorted by their own time, most expensive first
+	void	HotSpots(ostream& out) const;
+	//One line per call path, "prog;if:3;then:3;assign:4 nanoseconds",
+	//as read by flamegraph.pl and similar tools
+	void	Folded(ostream& out) const;
+};
+
+//Set once any thread has bound a profile
+extern bool profileBound;
+
+//Profile of the calling thread, or NULL when nothing is profiled
+extern thread_local Profile* activeProfile;
+
+inline Profile* ActiveProfile() { return profileBound ? activeProfile : NULL; }
+
+//Profile into p on the calling thread, or stop profiling with NULL
+extern void BindProfile(Profile* p);
+
+//Keeps a node of the bound profile open for as long as it is in scope
+class ProfileScope {
+	Profile* p;
+
+public:
+	ProfileScope(ProfKind kind, int line) : p(ActiveProfile()) {
+		if( p )
+			p->Enter(kind, line);
+	}
+	explicit ProfileScope(const string& program) : p(ActiveProfile()) {
+		if( p )
+			p->EnterProgram(program);
+	}
+	~ProfileScope() {
+		if( p )
+			p->Leave();
+	}
+};
+
+#endif /* PROFILE_H_ */
@@ -8,53 +8,530 @@
 
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <cstdlib>
 
 
 #include "parserInterp.h"
+#include "ast.h"
+#include "outsink.h"
+#include "instrument.h"
+#include "profile.h"
+#include "tokcache.h"
 
 
 using namespace std;
 
-int main(int argc, char *argv[])
+//run the optimization passes between Compile() and Execute()
+static bool optimize = true;
+
+//lex each file into a TokenArray before parsing it, on up to lexJobs
+//threads for large files
+static bool lexFirst = false;
+static unsigned lexJobs = 1;
+
+//directory of lexed sources kept between runs, or empty for none
+static string tokenCache;
+
+//with more than one file, sources that compiled cleanly are kept, keyed by
+//their text, and a source met again is executed without compiling it;
+//the programs are only read once kept, so workers share them
+static bool reuseCompiled = false;
+static mutex compiledLock;
+static unordered_map<string, shared_ptr<const CompiledProg> > compiled;
+static size_t compiledBytes = 0;
+
+//Room kept for compiled programs, counting their sources and nodes
+static const size_t CompiledBudget = 256u << 20;
+
+//The program compiled before from the same text as source, if any
+static shared_ptr<const CompiledProg> FindCompiled(const SourceMap& source)
+{
+	string text(source.Data(), source.Length());
+	lock_guard<mutex> hold(compiledLock);
+	auto found = compiled.find(text);
+	return found == compiled.end() ? shared_ptr<const CompiledProg>() : found->second;
+}
+
+//Keep prog, compiled and optimized from source, while there is room
+static void KeepCompiled(const SourceMap& source, const shared_ptr<CompiledProg>& prog)
+{
+	prog->exprs.shrink_to_fit();
+	size_t bytes = source.Length() + prog->exprs.size() * sizeof(ExprNode)
+		+ prog->consts.size() * sizeof(Value) + prog->stmts.size() * sizeof(StmtNode);
+	lock_guard<mutex> hold(compiledLock);
+	if( compiledBytes + bytes > CompiledBudget )
+		return;
+	if( compiled.emplace(string(source.Data(), source.Length()), prog).second )
+		compiledBytes += bytes;
+}
+
+//Lex all of the mapped source into tokens, counted and timed as lexing;
+//tokens read back from the cache are timed but not counted
+static void LexAll(const SourceMap& source, int line, TokenArray& tokens)
+{
+	PhaseTimer timer(PH_LEX);
+	LexBuffer buf = source.Buffer();
+	if( tokenCache.empty() )
+		Tokenize(buf, line, tokens, lexJobs);
+	else if( CachedTokenize(tokenCache, buf, line, tokens, lexJobs) )
+		return;
+	if( Counters* c = ActiveCounters() )
+		c->tokens += tokens.Size();
+}
+
+//Interpret one program from a clean state and report how it went
+static bool Run(istream& in, const string& fileName, bool compileFirst)
 {
 	int lineNumber = 1;
+	bool status;
+	ostream& out = *CurSession().out;
+
+	ResetInterp();
+	INSTR_COUNT(programs);
+	ProfileScope profiled(fileName);
+
+	//compile, or lex up front, from the file mapped into memory rather
+	//than through the stream
+	SourceMap source;
+	TokenArray tokens;
+	bool mapped = (compileFirst || lexFirst) && source.Open(fileName);
+    if( compileFirst )
+    {
+    	shared_ptr<const CompiledProg> kept;
+    	if( mapped && reuseCompiled )
+    		kept = FindCompiled(source);
+    	shared_ptr<CompiledProg> prog;
+    	if( kept )
+    	{
+    		status = true;
+    	}
+    	else
+    	{
+    		prog = make_shared<CompiledProg>();
+    		{
+    			PhaseTimer timer(PH_COMPILE);
+    			if( mapped && lexFirst )
+    			{
+    				LexAll(source, lineNumber, tokens);
+    				status = Compile(tokens, lineNumber, *prog);
+    			}
+    			else if( mapped )
+    			{
+    				LexBuffer buf = source.Buffer();
+    				status = Compile(buf, lineNumber, *prog);
+    			}
+    			else
+    			{
+    				status = Compile(in, lineNumber, *prog);
+    			}
+    		}
+    		if( status && optimize )
+    		{
+    			PhaseTimer timer(PH_OPTIMIZE);
+    			Optimize(*prog);
+    		}
+    		//a program that reported errors is compiled again to report them again
+    		if( status && mapped && reuseCompiled && ErrCount() == 0 )
+    			KeepCompiled(source, prog);
+    	}
+    	if( status )
+    	{
+    		PhaseTimer timer(PH_EXECUTE);
+    		status = Execute(kept ? *kept : *prog);
+    	}
+    }
+    else
+    {
+    	PhaseTimer timer(PH_INTERPRET);
+    	if( mapped )
+    	{
+    		LexAll(source, lineNumber, tokens);
+    		CurSession().tokens.Attach(&tokens);
+    	}
+    	status = Prog(in, lineNumber);
+    	CurSession().tokens.Clear();
+    }
+
+    if( !status ){
+    	out << "\nUnsuccessful Interpretation " << endl << "Number of Errors " << ErrCount()  << endl;
+	}
+	else{
+		out << "\nSuccessful Execution" << endl;
+	}
+	return status;
+}
+
+//Outcome of one program run by a worker thread
+struct BatchResult {
+	bool	done;
+	bool	opened;
+	bool	ok;
+	string	output;
+
+	BatchResult() : done(false), opened(false), ok(false) {}
+};
+
+//Run the files on a pool of worker threads, each program in its own
+//Session with its output captured; results are written to out in file
+//order as soon as they are ready. Every program reads its input from the
+//start of input[0, len), since a shared stream would be consumed in an
+//unpredictable order. With totals or profile set each worker counts or
+//profiles on its own and adds to them when it runs out of files.
+static int RunParallel(ostream& out, const vector<string>& files, bool compileFirst, unsigned jobs,
+	const char* input, size_t len, Counters* totals, Profile* profile)
+{
+	vector<BatchResult> results(files.size());
+	mutex lock;
+	condition_variable ready;
+	atomic<size_t> next(0);
+
+	auto worker = [&]() {
+		Counters mine;
+		Profile myProfile;
+		if( totals )
+			BindCounters(&mine);
+		if( profile )
+			BindProfile(&myProfile);
+		for( size_t i = next++; i < files.size(); i = next++ )
+		{
+			BatchResult r;
+			{
+				OutSink text(r.output);
+				InSource in(input, len);
+				Session session(text, in);
+
+				BindSession(&session);
+				ifstream file(files[i].c_str());
+				r.opened = file.is_open();
+				if( r.opened )
+					r.ok = Run(file, files[i], compileFirst);
+				BindSession(NULL);
+			}
+			r.done = true;
+			lock_guard<mutex> hold(lock);
+			results[i] = r;
+			ready.notify_all();
+		}
+		BindCounters(NULL);
+		BindProfile(NULL);
+		lock_guard<mutex> hold(lock);
+		if( totals )
+			totals->Merge(mine);
+		if( profile )
+			profile->Merge(myProfile);
+	};
+
+	if( jobs > files.size() )
+		jobs = files.size();
+	vector<thread> pool;
+	for( unsigned j = 0; j < jobs; j++ )
+		pool.push_back(thread(worker));
+
+	int failed = 0;
+	for( size_t i = 0; i < files.size(); i++ )
+	{
+		BatchResult r;
+		{
+			unique_lock<mutex> hold(lock);
+			ready.wait(hold, [&]() { return results[i].done; });
+			r.opened = results[i].opened;
+			r.ok = results[i].ok;
+			r.output.swap(results[i].output);
+		}
+		out << "==> " << files[i] << " <==" << endl;
+		if( !r.opened )
+		{
+			out.flush();
+			cerr << "CANNOT OPEN " << files[i] << endl;
+			failed++;
+			continue;
+		}
+		out << r.output << endl;
+		if( !r.ok )
+			failed++;
+	}
+
+	for( size_t j = 0; j < pool.size(); j++ )
+		pool[j].join();
+	return failed;
+}
+
+//Print the counters to standard error with -stats, and write them as
+//JSON to jsonFile with -stats-json; out is flushed first so the summary
+//follows the program output
+static void ReportStats(ostream& out, Counters& totals, chrono::steady_clock::time_point started,
+	bool summary, const string& jsonFile)
+{
+	if( !summary && jsonFile.empty() )
+		return;
+	out.flush();
+	totals.seconds[PH_TOTAL] = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+	if( summary )
+		totals.Print(cerr);
+	if( !jsonFile.empty() )
+	{
+		ofstream json(jsonFile.c_str());
+		if( json.is_open() == false )
+			cerr << "CANNOT OPEN " << jsonFile << endl;
+		else
+			totals.PrintJson(json);
+	}
+}
+
+//Print the hot spots to standard error with -profile, and write the
+//folded stacks to foldedFile with -profile-folded
+static void ReportProfile(ostream& out, const Profile& profile, bool hotSpots, const string& foldedFile)
+{
+	if( !hotSpots && foldedFile.empty() )
+		return;
+	out.flush();
+	if( hotSpots )
+		profile.HotSpots(cerr);
+	if( !foldedFile.empty() )
+	{
+		ofstream folded(foldedFile.c_str());
+		if( folded.is_open() == false )
+			cerr << "CANNOT OPEN " << foldedFile << endl;
+		else
+			profile.Folded(folded);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	vector<string> files;
+	bool compileFirst = false;
+	bool batch = false;
+	unsigned jobs = 1;
+	string inputFile;
+	bool statsSummary = false;
+	string statsJson;
+	bool hotSpots = false;
+	string foldedFile;
 
-	istream *in = NULL;
-	ifstream file;
-		
 	for( int i=1; i<argc; i++ )
     {
 		string arg = argv[i];
-		
-		if( in != NULL ) 
+
+		if( arg == "-compile" )
+		{
+			compileFirst = true;
+		}
+		else if( arg == "-noopt" )
+		{
+			//execute the compiled form exactly as parsed
+			optimize = false;
+		}
+		else if( arg == "-lexfirst" )
+		{
+			//lex the whole file before parsing and walk the tokens by index
+			lexFirst = true;
+		}
+		else if( arg == "-lexjobs" )
+		{
+			//threads lexing each large file; 0 means one per core
+			if( ++i == argc )
+			{
+				cerr << "Missing Number of Lexing Jobs." << endl;
+				return 0;
+			}
+			lexJobs = atoi(argv[i]);
+			if( lexJobs == 0 )
+				lexJobs = thread::hardware_concurrency();
+			if( lexJobs == 0 )
+				lexJobs = 1;
+			lexFirst = true;
+		}
+		else if( arg == "-tokcache" )
+		{
+			//reuse the tokens of sources lexed before, keyed by their text
+			if( ++i == argc )
+			{
+				cerr << "Missing Token Cache Directory." << endl;
+				return 0;
+			}
+			tokenCache = argv[i];
+			lexFirst = true;
+		}
+		else if( arg == "-batch" )
+		{
+			batch = true;
+		}
+		else if( arg == "-jobs" )
+		{
+			//number of worker threads for batch mode; 0 means one per core
+			if( ++i == argc )
+			{
+				cerr << "Missing Number of Jobs." << endl;
+				return 0;
+			}
+			jobs = atoi(argv[i]);
+			if( jobs == 0 )
+				jobs = thread::hardware_concurrency();
+			if( jobs == 0 )
+				jobs = 1;
+			batch = true;
+		}
+		else if( arg == "-input" )
+		{
+			//GET reads from this file instead of standard input
+			if( ++i == argc )
+			{
+				cerr << "Missing Input File Name." << endl;
+				return 0;
+			}
+			inputFile = argv[i];
+		}
+		else if( arg == "-stats" )
+		{
+			//count tokens, lookups, copies and statements, and time each phase
+			statsSummary = true;
+		}
+		else if( arg == "-stats-json" )
+		{
+			if( ++i == argc )
+			{
+				cerr << "Missing Stats File Name." << endl;
+				return 0;
+			}
+			statsJson = argv[i];
+		}
+		else if( arg == "-profile" )
+		{
+			//time and count every statement and list the most expensive
+			hotSpots = true;
+		}
+		else if( arg == "-profile-folded" )
+		{
+			if( ++i == argc )
+			{
+				cerr << "Missing Profile File Name." << endl;
+				return 0;
+			}
+			foldedFile = argv[i];
+		}
+		else if( arg == "-manifest" )
+		{
+			//one file name per line; blank lines and # comments are skipped
+			if( ++i == argc )
+			{
+				cerr << "Missing Manifest File Name." << endl;
+				return 0;
+			}
+			ifstream manifest(argv[i]);
+			if( manifest.is_open() == false )
+            {
+				cerr << "CANNOT OPEN " << argv[i] << endl;
+				return 0;
+			}
+			string name;
+			while( getline(manifest, name) )
+			{
+				if( !name.empty() && name[name.length()-1] == '\r' )
+					name.erase(name.length()-1);
+				if( !name.empty() && name[0] != '#' )
+					files.push_back(name);
+			}
+			batch = true;
+		}
+		else if( !batch && !files.empty() )
         {
 			cerr << "ONLY ONE FILE NAME ALLOWED" << endl;
 			return 0;
 		}
-		else 
+		else
         {
-			file.open(arg.c_str());
-			if( file.is_open() == false ) 
-            {
-				cerr << "CANNOT OPEN " << arg << endl;
-				return 0;
-			}
-
-			in = &file;
+			files.push_back(arg);
 		}
 	}
-    if(argc == 1)
+    if( files.empty() )
 	{
 		cerr << "Missing File Name." << endl;
 		return 0;
 	}
-	
-    bool status = Prog(*in, lineNumber);
-    
-    if( !status ){
-    	cout << "\nUnsuccessful Interpretation " << endl << "Number of Errors " << ErrCount()  << endl;
+
+	//input for GET, read in blocks from standard input or mapped from a file
+	SourceMap inputMap;
+	if( !inputFile.empty() && !inputMap.Open(inputFile) )
+	{
+		cerr << "CANNOT OPEN " << inputFile << endl;
+		return 0;
 	}
-	else{
-		cout << "\nSuccessful Execution" << endl;
+	InSource fileIn(inputMap.Data(), inputMap.Length());
+	InSource& in = inputFile.empty() ? StdIn() : fileIn;
+
+	//all output goes through one block-buffered sink on standard output
+	OutSink out(1);
+	Session session(out, in);
+	BindSession(&session);
+
+	//counters are only bound, and so only kept, when asked for
+	Counters totals;
+	bool counting = statsSummary || !statsJson.empty();
+	if( counting )
+		BindCounters(&totals);
+	Profile profile;
+	bool profiling = hotSpots || !foldedFile.empty();
+	if( profiling )
+		BindProfile(&profile);
+	chrono::steady_clock::time_point started = chrono::steady_clock::now();
+
+	int failed = 0;
+	reuseCompiled = files.size() > 1;
+	if( jobs > 1 )
+	{
+		//every worker starts from the beginning of the same input
+		string stdinText;
+		if( inputFile.empty() )
+		{
+			ostringstream text;
+			text << cin.rdbuf();
+			stdinText = text.str();
+		}
+		const char* input = inputFile.empty() ? stdinText.data() : inputMap.Data();
+		size_t len = inputFile.empty() ? stdinText.size() : inputMap.Length();
+		failed = RunParallel(out, files, compileFirst, jobs, input, len, counting ? &totals : NULL,
+			profiling ? &profile : NULL);
+		out << "Files Interpreted: " << files.size() << ", Unsuccessful: " << failed << endl;
+		ReportStats(out, totals, started, statsSummary, statsJson);
+		ReportProfile(out, profile, hotSpots, foldedFile);
+		return 0;
 	}
+
+	//batch mode runs every file in turn, each under its own heading
+	for( size_t i = 0; i < files.size(); i++ )
+	{
+		if( batch )
+			out << "==> " << files[i] << " <==" << endl;
+
+		ifstream file(files[i].c_str());
+		if( file.is_open() == false )
+        {
+			out.flush();
+			cerr << "CANNOT OPEN " << files[i] << endl;
+			if( !batch )
+				return 0;
+			failed++;
+			continue;
+		}
+
+		if( !Run(file, files[i], compileFirst) )
+			failed++;
+		if( batch )
+			out << endl;
+	}
+
+	if( batch )
+		out << "Files Interpreted: " << files.size() << ", Unsuccessful: " << failed << endl;
+	ReportStats(out, totals, started, statsSummary, statsJson);
+	ReportProfile(out, profile, hotSpots, foldedFile);
+	return 0;
 }
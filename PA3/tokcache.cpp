@@ -0,0 +1,67 @@
+/*
+ * tokcache.cpp
+ * On-disk cache of lexed SADAL sources
+ * CS280 - Spring 2025
+ */
+
+#include <unordered_map>
+
+#include "tokcache.h"
+#include "tokfile.h"
+
+static const char Magic[8] = { 'S', 'A', 'D', 'A', 'L', 'T', 'O', 'K' };
+
+bool CachedTokenize(const string& dir, LexBuffer& in, int& linenum, TokenArray& tokens, unsigned jobs)
+{
+	const char* start = in.Pos();
+	size_t length = in.End() - start;
+	string path = TokenFilePath(dir, SourceHash(start, length), ".tok");
+
+	TokenFile file;
+	if( LoadTokenFile(path, Magic, DONE + 1, start, length, file) && file.kinds.back() == DONE )
+	{
+		//each lexeme is interned once, however many tokens share it
+		vector<const string*> names;
+		names.reserve(file.names.size());
+		for( const string& name : file.names )
+			names.push_back(&Intern(name));
+
+		tokens.Clear();
+		tokens.kinds.swap(file.kinds);
+		tokens.offsets.swap(file.offsets);
+		tokens.lines.swap(file.lines);
+		tokens.ids.resize(tokens.Size());
+		for( size_t i = 0; i < tokens.Size(); i++ )
+		{
+			tokens.ids[i] = names[file.ids[i]];
+			tokens.lines[i] += linenum;
+		}
+		linenum = tokens.lines.back();
+		in.Seek(in.End());
+		return true;
+	}
+
+	//lex from line 0 so the file does not depend on where counting starts
+	int counted = 0;
+	Tokenize(in, counted, tokens, jobs);
+
+	file.kinds = tokens.kinds;
+	file.offsets = tokens.offsets;
+	file.lines = tokens.lines;
+	file.ids.resize(tokens.Size());
+	file.names.clear();
+	unordered_map<const string*, unsigned> index;
+	for( size_t i = 0; i < tokens.Size(); i++ )
+	{
+		auto found = index.emplace(tokens.ids[i], (unsigned) file.names.size());
+		if( found.second )
+			file.names.push_back(*tokens.ids[i]);
+		file.ids[i] = found.first->second;
+	}
+	SaveTokenFile(dir, path, Magic, DONE + 1, start, length, file);
+
+	for( int& l : tokens.lines )
+		l += linenum;
+	linenum += counted;
+	return false;
+}
@@ -0,0 +1,28 @@
+/*
+ * tokcache.h
+ * On-disk cache of lexed SADAL sources
+ *
+ * CS280 - Spring 2025
+ *
+ * A source lexed once is saved to the cache directory, in the format of
+ * tokfile.h, under a name taken from a hash of its text. Lexing the same
+ * text again maps that file instead of running the lexer. A changed
+ * source misses, and so does one whose hash collides, since a file is
+ * only used when the copy of the source it holds matches. A file that
+ * does not check out is written afresh.
+*/
+
+#ifndef TOKCACHE_H_
+#define TOKCACHE_H_
+
+#include <string>
+
+#include "lex.h"
+
+using namespace std;
+
+//Tokenize(in, linenum, tokens, jobs) through the cache in dir; true when
+//the tokens came from the cache
+extern bool CachedTokenize(const string& dir, LexBuffer& in, int& linenum, TokenArray& tokens, unsigned jobs);
+
+#endif /* TOKCACHE_H_ */
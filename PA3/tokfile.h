@@ -0,0 +1,268 @@
+/*
+ * tokfile.h
+ * File format of the token caches of prog2 and prog3
+ *
+ * CS280 - Spring 2025
+ *
+ * A token file holds a lexed source as flat arrays: one kind, offset,
+ * line and lexeme index per token, the distinct lexemes, and the source
+ * text itself. A file is only used for a source whose text matches the
+ * stored copy byte for byte, so a hash that collides costs a miss and
+ * never the wrong tokens. A hash of everything after the header catches
+ * a file damaged on disk.
+ *
+ * Both parsers include this header; each maps its own TokenArray to and
+ * from the arrays here. It is kept free of the lexers' headers so PA2
+ * can use it without PA3's Token numbering.
+*/
+
+#ifndef TOKFILE_H_
+#define TOKFILE_H_
+
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define TOKFILE_HAVE_POSIX 1
+#endif
+
+using namespace std;
+
+//Token arrays as stored; ids index names
+struct TokenFile {
+	vector<unsigned char> kinds;
+	vector<unsigned> offsets;
+	vector<int>	lines;		// counted from line 0
+	vector<unsigned> ids;
+	vector<string>	names;
+};
+
+//64-bit FNV-1a style hash of len bytes at data, taken eight bytes at a
+//time and a byte at a time for the tail; it only names and checks files
+inline unsigned long long SourceHash(const char* data, size_t len)
+{
+	uint64_t h = 14695981039346656037ULL;
+	size_t i = 0;
+	for( ; i + 8 <= len; i += 8 )
+	{
+		uint64_t word;
+		memcpy(&word, data + i, 8);
+		h ^= word;
+		h *= 1099511628211ULL;
+		h ^= h >> 32;
+	}
+	for( ; i < len; i++ )
+	{
+		h ^= (unsigned char) data[i];
+		h *= 1099511628211ULL;
+	}
+	return h;
+}
+
+//The file starts with this header and goes on with
+//	source	length bytes
+//	offsets	uint32_t[count]
+//	lines	int32_t[count]
+//	ids	uint32_t[count]
+//	kinds	uint8_t[count]
+//	names	names times a uint32_t length and that many bytes
+//all in the byte order of the machine that wrote it
+struct TokenFileHeader {
+	char	magic[8];		// names the parser, whose Token numbering it is
+	uint32_t version;
+	uint32_t count;			// tokens
+	uint64_t hash;			// SourceHash() of the source
+	uint64_t length;		// bytes in the source
+	uint64_t check;			// SourceHash() of everything after the header
+	uint32_t names;			// distinct lexemes
+	uint32_t unused;
+};
+
+//Bumped whenever the layout above changes
+static const uint32_t TokenFileFormat = 2;
+
+//A file mapped into memory, or read into it where mmap is missing
+class MappedFile {
+	const char* data;
+	size_t	len;
+	bool	mapped;
+	string	copy;
+
+	MappedFile(const MappedFile&);
+	MappedFile& operator=(const MappedFile&);
+
+public:
+	MappedFile() : data(NULL), len(0), mapped(false) {}
+	~MappedFile() {
+#ifdef TOKFILE_HAVE_POSIX
+		if( mapped )
+			munmap((void*) data, len);
+#endif
+	}
+
+	bool Open(const string& path) {
+#ifdef TOKFILE_HAVE_POSIX
+		int fd = open(path.c_str(), O_RDONLY);
+		if( fd < 0 )
+			return false;
+		struct stat st;
+		if( fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 )
+		{
+			void* p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if( p != MAP_FAILED )
+			{
+				::close(fd);
+				data = (const char*) p;
+				len = st.st_size;
+				mapped = true;
+				return true;
+			}
+		}
+		::close(fd);
+#endif
+		ifstream file(path.c_str(), ios::in | ios::binary);
+		if( !file.is_open() )
+			return false;
+		ostringstream text;
+		text << file.rdbuf();
+		copy = text.str();
+		data = copy.data();
+		len = copy.size();
+		return true;
+	}
+
+	const char* Data() const { return data; }
+	size_t	Length() const { return len; }
+};
+
+//Where the tokens of a source with this hash are kept in dir
+inline string TokenFilePath(const string& dir, unsigned long long hash, const char* suffix)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx", hash);
+	return dir + "/" + name + suffix;
+}
+
+//Read path into tokens if it was written by the parser named magic, with
+//kinds numbered up to kinds, for exactly the len bytes at source; false
+//otherwise, leaving tokens in no particular state
+inline bool LoadTokenFile(const string& path, const char magic[8], unsigned kinds,
+	const char* source, size_t len, TokenFile& tokens)
+{
+	MappedFile file;
+	if( !file.Open(path) || file.Length() < sizeof(TokenFileHeader) )
+		return false;
+
+	TokenFileHeader h;
+	memcpy(&h, file.Data(), sizeof(h));
+	if( memcmp(h.magic, magic, sizeof(h.magic)) != 0 || h.version != ((TokenFileFormat << 8) | kinds)
+		|| h.length != len || h.hash != SourceHash(source, len) || h.count == 0 )
+		return false;
+
+	const char* p = file.Data() + sizeof(h);
+	const char* end = file.Data() + file.Length();
+	size_t count = h.count;
+	if( (size_t)(end - p) < len + count * 13 || SourceHash(p, end - p) != h.check )
+		return false;
+	if( memcmp(p, source, len) != 0 )
+		return false;
+	p += len;
+
+	tokens.offsets.resize(count);
+	tokens.lines.resize(count);
+	tokens.ids.resize(count);
+	tokens.kinds.resize(count);
+	memcpy(&tokens.offsets[0], p, count * 4);
+	memcpy(&tokens.lines[0], p + count * 4, count * 4);
+	memcpy(&tokens.ids[0], p + count * 8, count * 4);
+	memcpy(&tokens.kinds[0], p + count * 12, count);
+	p += count * 13;
+
+	tokens.names.clear();
+	tokens.names.reserve(h.names);
+	for( uint32_t i = 0; i < h.names; i++ )
+	{
+		uint32_t n;
+		if( end - p < 4 )
+			return false;
+		memcpy(&n, p, 4);
+		p += 4;
+		if( (size_t)(end - p) < n )
+			return false;
+		tokens.names.push_back(string(p, n));
+		p += n;
+	}
+	for( size_t i = 0; i < count; i++ )
+	{
+		if( tokens.ids[i] >= h.names || tokens.kinds[i] >= kinds )
+			return false;
+	}
+	return true;
+}
+
+//Write tokens for the len bytes at source to path, creating dir if need
+//be. The file is written under a name of its own and renamed into place,
+//so readers never see half of it; a cache that cannot be written is
+//simply not used.
+inline void SaveTokenFile(const string& dir, const string& path, const char magic[8], unsigned kinds,
+	const char* source, size_t len, const TokenFile& tokens)
+{
+	size_t count = tokens.kinds.size();
+	TokenFileHeader h;
+	memcpy(h.magic, magic, sizeof(h.magic));
+	h.version = (TokenFileFormat << 8) | kinds;
+	h.count = (uint32_t) count;
+	h.hash = SourceHash(source, len);
+	h.length = len;
+	h.names = (uint32_t) tokens.names.size();
+	h.unused = 0;
+
+	string body(source, len);
+	body.append((const char*) &tokens.offsets[0], count * 4);
+	body.append((const char*) &tokens.lines[0], count * 4);
+	body.append((const char*) &tokens.ids[0], count * 4);
+	body.append((const char*) &tokens.kinds[0], count);
+	for( const string& name : tokens.names )
+	{
+		uint32_t n = (uint32_t) name.size();
+		body.append((const char*) &n, 4);
+		body.append(name);
+	}
+	h.check = SourceHash(body.data(), body.size());
+
+	ostringstream temp;
+	temp << path << "." << this_thread::get_id();
+#ifdef TOKFILE_HAVE_POSIX
+	mkdir(dir.c_str(), 0777);
+	temp << "." << getpid();
+#endif
+	temp << ".tmp";
+
+	{
+		ofstream out(temp.str().c_str(), ios::out | ios::binary | ios::trunc);
+		if( !out.is_open() )
+			return;
+		out.write((const char*) &h, sizeof(h));
+		out.write(body.data(), body.size());
+		if( !out.good() )
+		{
+			out.close();
+			remove(temp.str().c_str());
+			return;
+		}
+	}
+	if( rename(temp.str().c_str(), path.c_str()) != 0 )
+		remove(temp.str().c_str());
+}
+
+#endif /* TOKFILE_H_ */
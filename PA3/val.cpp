@@ -1,6 +1,7 @@
 // val.cpp
 #include "val.h"
 #include <cmath>
+#include <cstdio>
 
 // Arithmetic: +, -, *, /
 Value Value::operator+(const Value& op) const {
@@ -146,6 +147,23 @@ Value Value::Concat(const Value& op) const {
     return Value();
 }
 
+Value& Value::Append(const Value& op) {
+    if (T == VSTRING && op.T == VSTRING) {
+        Stemp += op.Stemp;
+    }
+    else if (T == VSTRING && op.T == VCHAR) {
+        Stemp.push_back(op.Ctemp);
+    }
+    else {
+        // char on the left or an error: no string to grow yet
+        *this = Concat(op);
+        return *this;
+    }
+    strcurrLen = Stemp.length();
+    strLen = strcurrLen;
+    return *this;
+}
+
 // Exponentiation (floats only)
 Value Value::Exp(const Value& op) const {
     if (T == VREAL && op.T == VREAL) {
@@ -156,3 +174,53 @@ Value Value::Exp(const Value& op) const {
     }
     return Value();
 }
+
+// Decimal digits of an integer into buf; returns the length
+static int FormatInt(char* buf, long long v) {
+    char digits[24];
+    int n = 0, len = 0;
+    unsigned long long u = v < 0 ? 0ULL - (unsigned long long)v : v;
+    do {
+        digits[n++] = '0' + u % 10;
+        u /= 10;
+    } while (u != 0);
+    if (v < 0) buf[len++] = '-';
+    while (n > 0) buf[len++] = digits[--n];
+    return len;
+}
+
+// r as "%.2f" prints it into buf, which holds at least 320 characters
+// (DBL_MAX has 309 digits); returns the length. Below 1e9 the product r * 100
+// is within 1e-5 of the exact one, so unless it lies next to a rounding
+// tie it rounds to the same cents; anything else goes to snprintf.
+static int FormatReal(char* buf, double r) {
+    double a = std::fabs(r);
+    if (a < 1e9) {
+        double scaled = a * 100.0;
+        double whole = std::floor(scaled);
+        double frac = scaled - whole;
+        if (std::fabs(frac - 0.5) > 1e-4) {
+            long long cents = (long long)whole + (frac > 0.5 ? 1 : 0);
+            int len = 0;
+            if (std::signbit(r)) buf[len++] = '-';
+            len += FormatInt(buf + len, cents / 100);
+            buf[len++] = '.';
+            buf[len++] = '0' + (cents % 100) / 10;
+            buf[len++] = '0' + cents % 10;
+            return len;
+        }
+    }
+    return snprintf(buf, 320, "%.2f", r);
+}
+
+void Value::Write(ostream& out) const {
+    char buf[320];
+    switch (T) {
+        case VINT:    out.write(buf, FormatInt(buf, Itemp)); break;
+        case VREAL:   out.write(buf, FormatReal(buf, Rtemp)); break;
+        case VBOOL:   out << (Btemp ? "true" : "false"); break;
+        case VCHAR:   out.put(Ctemp); break;
+        case VSTRING: out.write(Stemp.data(), Stemp.size()); break;
+        default:      out << "ERROR"; break;
+    }
+}
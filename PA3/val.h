@@ -9,6 +9,10 @@
 #include <stdexcept>
 #include <cmath>
 #include <sstream>
+#include <new>
+#include <utility>
+
+#include "instrument.h"
 
 using namespace std;
 
@@ -16,33 +20,96 @@ enum ValType { VINT, VREAL, VSTRING, VCHAR, VBOOL, VERR };
 
 class Value {
     ValType	T;
-    bool    Btemp;
-    int 	Itemp;
-	double   Rtemp;
-	string	Stemp;
-    char 	Ctemp;
     int strcurrLen;
     int strLen;
+    // only the member selected by T is live; Stemp is constructed and
+    // destroyed by hand, so copying a non-string Value never touches a string
+    union {
+        bool    Btemp;
+        int 	Itemp;
+        double   Rtemp;
+        char 	Ctemp;
+        string	Stemp;
+    };
+    
+    void Copy(const Value& v) {
+        switch( v.T ) {
+            case VSTRING: new (&Stemp) string(v.Stemp); break;
+            case VBOOL:   Btemp = v.Btemp; break;
+            case VINT:    Itemp = v.Itemp; break;
+            case VCHAR:   Ctemp = v.Ctemp; break;
+            default:      Rtemp = v.Rtemp; break;
+        }
+    }
+    void Move(Value& v) noexcept {
+        switch( v.T ) {
+            case VSTRING: new (&Stemp) string(std::move(v.Stemp)); break;
+            case VBOOL:   Btemp = v.Btemp; break;
+            case VINT:    Itemp = v.Itemp; break;
+            case VCHAR:   Ctemp = v.Ctemp; break;
+            default:      Rtemp = v.Rtemp; break;
+        }
+    }
+    void Release() {
+        if( T == VSTRING )
+            Stemp.~string();
+    }
         
        
 public:
-    Value() : T(VERR), Btemp(false), Itemp(0), Rtemp(0.0), Stemp(""), Ctemp(0) {}
-    Value(bool vb) : T(VBOOL), Btemp(vb), Itemp(0), Rtemp(0.0), Stemp(""), Ctemp(0) {}
-    Value(int vi) : T(VINT), Btemp(false), Itemp(vi), Rtemp(0.0), Stemp(""), Ctemp(0) {}
-    Value(double vr) : T(VREAL), Btemp(false), Itemp(0), Rtemp(vr), Stemp(""), Ctemp(0) {}
-    Value(string vs) : T(VSTRING), Btemp(false), Itemp(0), Rtemp(0.0), Stemp(vs), Ctemp(0) { 
-		if(vs.length() == 0)
+    Value() : T(VERR), strcurrLen(0), strLen(0), Rtemp(0.0) {}
+    Value(bool vb) : T(VBOOL), strcurrLen(0), strLen(0), Rtemp(0.0) { Btemp = vb; }
+    Value(int vi) : T(VINT), strcurrLen(0), strLen(0), Rtemp(0.0) { Itemp = vi; }
+    Value(double vr) : T(VREAL), strcurrLen(0), strLen(0), Rtemp(vr) {}
+    Value(string vs) : T(VSTRING), strcurrLen(0), strLen(0), Stemp(std::move(vs)) { 
+		if(Stemp.length() == 0)
 		{
 			strcurrLen = 0;
 			//strLen should be set by using the SetstrLen() function
 		}
 		else
 		{
-			strcurrLen = vs.length();
+			strcurrLen = Stemp.length();
 			strLen = strcurrLen;
 		}
 	}
-    Value(char vs) : T(VCHAR), Btemp(false), Itemp(0), Rtemp(0.0), Stemp(""), Ctemp(vs) { }
+    Value(char vs) : T(VCHAR), strcurrLen(0), strLen(0), Rtemp(0.0) { Ctemp = vs; }
+    
+    Value(const Value& v) : T(v.T), strcurrLen(v.strcurrLen), strLen(v.strLen), Rtemp(0.0) { INSTR_COUNT(valueCopies); Copy(v); }
+    Value(Value&& v) noexcept : T(v.T), strcurrLen(v.strcurrLen), strLen(v.strLen), Rtemp(0.0) { Move(v); }
+    ~Value() { Release(); }
+    
+    Value& operator=(const Value& v) {
+        if( this == &v )
+            return *this;
+        INSTR_COUNT(valueCopies);
+        if( T == VSTRING && v.T == VSTRING )
+            Stemp = v.Stemp;
+        else
+        {
+            Release();
+            Copy(v);
+        }
+        T = v.T;
+        strcurrLen = v.strcurrLen;
+        strLen = v.strLen;
+        return *this;
+    }
+    Value& operator=(Value&& v) noexcept {
+        if( this == &v )
+            return *this;
+        if( T == VSTRING && v.T == VSTRING )
+            Stemp = std::move(v.Stemp);
+        else
+        {
+            Release();
+            Move(v);
+        }
+        T = v.T;
+        strcurrLen = v.strcurrLen;
+        strLen = v.strLen;
+        return *this;
+    }
     
     
     ValType GetType() const { return T; }
@@ -55,7 +122,7 @@ public:
     
     int GetInt() const { if( IsInt() ) return Itemp; throw "RUNTIME ERROR: Value not an Integer"; }
     
-    string GetString() const { if( IsString() ) return Stemp; throw "RUNTIME ERROR: Value not a String"; }
+    const string& GetString() const { if( IsString() ) return Stemp; throw "RUNTIME ERROR: Value not a String"; }
     
     double GetReal() const { if( IsReal() ) return Rtemp; throw "RUNTIME ERROR: Value not an Float"; }
     
@@ -65,6 +132,13 @@ public:
     
     void SetType(ValType type)
     {
+    	if( type == T )
+    		return;
+    	Release();
+    	if( type == VSTRING )
+    		new (&Stemp) string();
+    	else
+    		Rtemp = 0.0;
     	T = type;
 	}
 	
@@ -172,16 +246,18 @@ public:
 	//Concatenation &: Concatenate this with op
     Value Concat(const Value & op) const;
     
+    //Concatenation in place: this = this & op, reusing this string's storage
+    Value& Append(const Value & op);
+    
     //Exponentiation **: raise this to the power of op
     Value Exp(const Value & op) const;
 	
+    //Write the value as PUT prints it; floats get two decimals. The text is
+    //formatted here, so the stream's flags are neither used nor changed.
+    void Write(ostream& out) const;
+	
     friend ostream& operator<<(ostream& out, const Value& op) {
-        if( op.IsInt() ) out << op.Itemp;
-        else if(op.IsBool()) out << (op.GetBool()? "true": "false");
-        else if( op.IsChar() ) out << op.Ctemp ;
-		else if( op.IsString() ) out << op.Stemp ;
-        else if( op.IsReal()) out << fixed << showpoint << setprecision(2) << op.Rtemp;
-        else if(op.IsErr()) out << "ERROR";
+        op.Write(out);
         return out;
     }
 };